@@ -0,0 +1,15 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/parser_benchmark.dir/__/src/parser.cpp.o"
+  "CMakeFiles/parser_benchmark.dir/__/src/parser.cpp.o.d"
+  "CMakeFiles/parser_benchmark.dir/__/src/utils.cpp.o"
+  "CMakeFiles/parser_benchmark.dir/__/src/utils.cpp.o.d"
+  "CMakeFiles/parser_benchmark.dir/parser.cpp.o"
+  "CMakeFiles/parser_benchmark.dir/parser.cpp.o.d"
+  "parser_benchmark"
+  "parser_benchmark.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/parser_benchmark.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/rowdiff_benchmark.dir/rowdiff.cpp.o"
+  "CMakeFiles/rowdiff_benchmark.dir/rowdiff.cpp.o.d"
+  "rowdiff_benchmark"
+  "rowdiff_benchmark.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/rowdiff_benchmark.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
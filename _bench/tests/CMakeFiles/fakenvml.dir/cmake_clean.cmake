@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/fakenvml.dir/fakenvml.cpp.o"
+  "CMakeFiles/fakenvml.dir/fakenvml.cpp.o.d"
+  "libfakenvml.pdb"
+  "libfakenvml.so"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/fakenvml.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/history_test.dir/__/src/history.cpp.o"
+  "CMakeFiles/history_test.dir/__/src/history.cpp.o.d"
+  "CMakeFiles/history_test.dir/history.cpp.o"
+  "CMakeFiles/history_test.dir/history.cpp.o.d"
+  "history_test"
+  "history_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/history_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
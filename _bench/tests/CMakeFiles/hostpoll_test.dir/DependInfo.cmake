@@ -0,0 +1,22 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/hostpoll.cpp" "tests/CMakeFiles/hostpoll_test.dir/__/src/hostpoll.cpp.o" "gcc" "tests/CMakeFiles/hostpoll_test.dir/__/src/hostpoll.cpp.o.d"
+  "/root/repo/src/parser.cpp" "tests/CMakeFiles/hostpoll_test.dir/__/src/parser.cpp.o" "gcc" "tests/CMakeFiles/hostpoll_test.dir/__/src/parser.cpp.o.d"
+  "/root/repo/src/utils.cpp" "tests/CMakeFiles/hostpoll_test.dir/__/src/utils.cpp.o" "gcc" "tests/CMakeFiles/hostpoll_test.dir/__/src/utils.cpp.o.d"
+  "/root/repo/tests/hostpoll.cpp" "tests/CMakeFiles/hostpoll_test.dir/hostpoll.cpp.o" "gcc" "tests/CMakeFiles/hostpoll_test.dir/hostpoll.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,17 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/hostpoll_test.dir/__/src/hostpoll.cpp.o"
+  "CMakeFiles/hostpoll_test.dir/__/src/hostpoll.cpp.o.d"
+  "CMakeFiles/hostpoll_test.dir/__/src/parser.cpp.o"
+  "CMakeFiles/hostpoll_test.dir/__/src/parser.cpp.o.d"
+  "CMakeFiles/hostpoll_test.dir/__/src/utils.cpp.o"
+  "CMakeFiles/hostpoll_test.dir/__/src/utils.cpp.o.d"
+  "CMakeFiles/hostpoll_test.dir/hostpoll.cpp.o"
+  "CMakeFiles/hostpoll_test.dir/hostpoll.cpp.o.d"
+  "hostpoll_test"
+  "hostpoll_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/hostpoll_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/metrics_test.dir/__/src/metrics.cpp.o"
+  "CMakeFiles/metrics_test.dir/__/src/metrics.cpp.o.d"
+  "CMakeFiles/metrics_test.dir/metrics.cpp.o"
+  "CMakeFiles/metrics_test.dir/metrics.cpp.o.d"
+  "metrics_test"
+  "metrics_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/metrics_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/nametable_test.dir/__/src/nametable.cpp.o"
+  "CMakeFiles/nametable_test.dir/__/src/nametable.cpp.o.d"
+  "CMakeFiles/nametable_test.dir/nametable.cpp.o"
+  "CMakeFiles/nametable_test.dir/nametable.cpp.o.d"
+  "nametable_test"
+  "nametable_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/nametable_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
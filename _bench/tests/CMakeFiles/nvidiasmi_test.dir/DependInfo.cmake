@@ -0,0 +1,26 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/nvidiasmi.cpp" "tests/CMakeFiles/nvidiasmi_test.dir/__/src/nvidiasmi.cpp.o" "gcc" "tests/CMakeFiles/nvidiasmi_test.dir/__/src/nvidiasmi.cpp.o.d"
+  "/root/repo/src/parser.cpp" "tests/CMakeFiles/nvidiasmi_test.dir/__/src/parser.cpp.o" "gcc" "tests/CMakeFiles/nvidiasmi_test.dir/__/src/parser.cpp.o.d"
+  "/root/repo/src/sampler.cpp" "tests/CMakeFiles/nvidiasmi_test.dir/__/src/sampler.cpp.o" "gcc" "tests/CMakeFiles/nvidiasmi_test.dir/__/src/sampler.cpp.o.d"
+  "/root/repo/src/stream.cpp" "tests/CMakeFiles/nvidiasmi_test.dir/__/src/stream.cpp.o" "gcc" "tests/CMakeFiles/nvidiasmi_test.dir/__/src/stream.cpp.o.d"
+  "/root/repo/src/topology.cpp" "tests/CMakeFiles/nvidiasmi_test.dir/__/src/topology.cpp.o" "gcc" "tests/CMakeFiles/nvidiasmi_test.dir/__/src/topology.cpp.o.d"
+  "/root/repo/src/utils.cpp" "tests/CMakeFiles/nvidiasmi_test.dir/__/src/utils.cpp.o" "gcc" "tests/CMakeFiles/nvidiasmi_test.dir/__/src/utils.cpp.o.d"
+  "/root/repo/tests/nvidiasmi.cpp" "tests/CMakeFiles/nvidiasmi_test.dir/nvidiasmi.cpp.o" "gcc" "tests/CMakeFiles/nvidiasmi_test.dir/nvidiasmi.cpp.o.d"
+  "/root/repo/tests/settings.cpp" "tests/CMakeFiles/nvidiasmi_test.dir/settings.cpp.o" "gcc" "tests/CMakeFiles/nvidiasmi_test.dir/settings.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
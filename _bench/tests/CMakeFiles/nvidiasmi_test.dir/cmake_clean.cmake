@@ -0,0 +1,25 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/nvidiasmi_test.dir/__/src/nvidiasmi.cpp.o"
+  "CMakeFiles/nvidiasmi_test.dir/__/src/nvidiasmi.cpp.o.d"
+  "CMakeFiles/nvidiasmi_test.dir/__/src/parser.cpp.o"
+  "CMakeFiles/nvidiasmi_test.dir/__/src/parser.cpp.o.d"
+  "CMakeFiles/nvidiasmi_test.dir/__/src/sampler.cpp.o"
+  "CMakeFiles/nvidiasmi_test.dir/__/src/sampler.cpp.o.d"
+  "CMakeFiles/nvidiasmi_test.dir/__/src/stream.cpp.o"
+  "CMakeFiles/nvidiasmi_test.dir/__/src/stream.cpp.o.d"
+  "CMakeFiles/nvidiasmi_test.dir/__/src/topology.cpp.o"
+  "CMakeFiles/nvidiasmi_test.dir/__/src/topology.cpp.o.d"
+  "CMakeFiles/nvidiasmi_test.dir/__/src/utils.cpp.o"
+  "CMakeFiles/nvidiasmi_test.dir/__/src/utils.cpp.o.d"
+  "CMakeFiles/nvidiasmi_test.dir/nvidiasmi.cpp.o"
+  "CMakeFiles/nvidiasmi_test.dir/nvidiasmi.cpp.o.d"
+  "CMakeFiles/nvidiasmi_test.dir/settings.cpp.o"
+  "CMakeFiles/nvidiasmi_test.dir/settings.cpp.o.d"
+  "nvidiasmi_test"
+  "nvidiasmi_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/nvidiasmi_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
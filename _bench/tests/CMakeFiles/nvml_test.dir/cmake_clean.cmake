@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/nvml_test.dir/__/src/nvml.cpp.o"
+  "CMakeFiles/nvml_test.dir/__/src/nvml.cpp.o.d"
+  "CMakeFiles/nvml_test.dir/nvml.cpp.o"
+  "CMakeFiles/nvml_test.dir/nvml.cpp.o.d"
+  "nvml_test"
+  "nvml_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/nvml_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/procfs_test.dir/__/src/procfs.cpp.o"
+  "CMakeFiles/procfs_test.dir/__/src/procfs.cpp.o.d"
+  "CMakeFiles/procfs_test.dir/procfs.cpp.o"
+  "CMakeFiles/procfs_test.dir/procfs.cpp.o.d"
+  "procfs_test"
+  "procfs_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/procfs_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
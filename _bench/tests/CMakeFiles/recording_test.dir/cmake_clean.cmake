@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/recording_test.dir/__/src/recording.cpp.o"
+  "CMakeFiles/recording_test.dir/__/src/recording.cpp.o.d"
+  "CMakeFiles/recording_test.dir/recording.cpp.o"
+  "CMakeFiles/recording_test.dir/recording.cpp.o.d"
+  "recording_test"
+  "recording_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/recording_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
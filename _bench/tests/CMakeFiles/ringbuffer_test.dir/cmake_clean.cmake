@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/ringbuffer_test.dir/ringbuffer.cpp.o"
+  "CMakeFiles/ringbuffer_test.dir/ringbuffer.cpp.o.d"
+  "ringbuffer_test"
+  "ringbuffer_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/ringbuffer_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/rowdiff_test.dir/rowdiff.cpp.o"
+  "CMakeFiles/rowdiff_test.dir/rowdiff.cpp.o.d"
+  "rowdiff_test"
+  "rowdiff_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/rowdiff_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/run_test.dir/__/src/utils.cpp.o"
+  "CMakeFiles/run_test.dir/__/src/utils.cpp.o.d"
+  "CMakeFiles/run_test.dir/run.cpp.o"
+  "CMakeFiles/run_test.dir/run.cpp.o.d"
+  "run_test"
+  "run_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/run_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,17 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/sampler_test.dir/__/src/parser.cpp.o"
+  "CMakeFiles/sampler_test.dir/__/src/parser.cpp.o.d"
+  "CMakeFiles/sampler_test.dir/__/src/sampler.cpp.o"
+  "CMakeFiles/sampler_test.dir/__/src/sampler.cpp.o.d"
+  "CMakeFiles/sampler_test.dir/__/src/topology.cpp.o"
+  "CMakeFiles/sampler_test.dir/__/src/topology.cpp.o.d"
+  "CMakeFiles/sampler_test.dir/sampler.cpp.o"
+  "CMakeFiles/sampler_test.dir/sampler.cpp.o.d"
+  "sampler_test"
+  "sampler_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/sampler_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
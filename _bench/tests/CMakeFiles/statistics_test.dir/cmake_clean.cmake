@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/statistics_test.dir/__/src/statistics.cpp.o"
+  "CMakeFiles/statistics_test.dir/__/src/statistics.cpp.o.d"
+  "CMakeFiles/statistics_test.dir/statistics.cpp.o"
+  "CMakeFiles/statistics_test.dir/statistics.cpp.o.d"
+  "statistics_test"
+  "statistics_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/statistics_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,21 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/stream.cpp" "tests/CMakeFiles/stream_test.dir/__/src/stream.cpp.o" "gcc" "tests/CMakeFiles/stream_test.dir/__/src/stream.cpp.o.d"
+  "/root/repo/src/utils.cpp" "tests/CMakeFiles/stream_test.dir/__/src/utils.cpp.o" "gcc" "tests/CMakeFiles/stream_test.dir/__/src/utils.cpp.o.d"
+  "/root/repo/tests/stream.cpp" "tests/CMakeFiles/stream_test.dir/stream.cpp.o" "gcc" "tests/CMakeFiles/stream_test.dir/stream.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,15 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/stream_test.dir/__/src/stream.cpp.o"
+  "CMakeFiles/stream_test.dir/__/src/stream.cpp.o.d"
+  "CMakeFiles/stream_test.dir/__/src/utils.cpp.o"
+  "CMakeFiles/stream_test.dir/__/src/utils.cpp.o.d"
+  "CMakeFiles/stream_test.dir/stream.cpp.o"
+  "CMakeFiles/stream_test.dir/stream.cpp.o.d"
+  "stream_test"
+  "stream_test.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/stream_test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
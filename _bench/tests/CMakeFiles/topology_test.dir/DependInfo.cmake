@@ -0,0 +1,20 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/topology.cpp" "tests/CMakeFiles/topology_test.dir/__/src/topology.cpp.o" "gcc" "tests/CMakeFiles/topology_test.dir/__/src/topology.cpp.o.d"
+  "/root/repo/tests/topology.cpp" "tests/CMakeFiles/topology_test.dir/topology.cpp.o" "gcc" "tests/CMakeFiles/topology_test.dir/topology.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,36 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo/tests
+# Build directory: /root/repo/_bench/tests
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+add_test(sampler "/root/repo/_bench/tests/sampler_test")
+set_tests_properties(sampler PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;8;add_test;/root/repo/tests/CMakeLists.txt;13;nvsm_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(stream "/root/repo/_bench/tests/stream_test")
+set_tests_properties(stream PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;8;add_test;/root/repo/tests/CMakeLists.txt;14;nvsm_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(history "/root/repo/_bench/tests/history_test")
+set_tests_properties(history PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;8;add_test;/root/repo/tests/CMakeLists.txt;15;nvsm_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(hostpoll "/root/repo/_bench/tests/hostpoll_test")
+set_tests_properties(hostpoll PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;8;add_test;/root/repo/tests/CMakeLists.txt;16;nvsm_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(metrics "/root/repo/_bench/tests/metrics_test")
+set_tests_properties(metrics PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;8;add_test;/root/repo/tests/CMakeLists.txt;17;nvsm_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(nametable "/root/repo/_bench/tests/nametable_test")
+set_tests_properties(nametable PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;8;add_test;/root/repo/tests/CMakeLists.txt;18;nvsm_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(nvidiasmi "/root/repo/_bench/tests/nvidiasmi_test")
+set_tests_properties(nvidiasmi PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;8;add_test;/root/repo/tests/CMakeLists.txt;20;nvsm_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(procfs "/root/repo/_bench/tests/procfs_test")
+set_tests_properties(procfs PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;8;add_test;/root/repo/tests/CMakeLists.txt;22;nvsm_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(recording "/root/repo/_bench/tests/recording_test")
+set_tests_properties(recording PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;8;add_test;/root/repo/tests/CMakeLists.txt;23;nvsm_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(ringbuffer "/root/repo/_bench/tests/ringbuffer_test")
+set_tests_properties(ringbuffer PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;8;add_test;/root/repo/tests/CMakeLists.txt;24;nvsm_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(rowdiff "/root/repo/_bench/tests/rowdiff_test")
+set_tests_properties(rowdiff PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;8;add_test;/root/repo/tests/CMakeLists.txt;25;nvsm_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(run "/root/repo/_bench/tests/run_test")
+set_tests_properties(run PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;8;add_test;/root/repo/tests/CMakeLists.txt;26;nvsm_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(statistics "/root/repo/_bench/tests/statistics_test")
+set_tests_properties(statistics PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;8;add_test;/root/repo/tests/CMakeLists.txt;27;nvsm_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(topology "/root/repo/_bench/tests/topology_test")
+set_tests_properties(topology PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;8;add_test;/root/repo/tests/CMakeLists.txt;28;nvsm_test;/root/repo/tests/CMakeLists.txt;0;")
+add_test(nvml "/root/repo/_bench/tests/nvml_test")
+set_tests_properties(nvml PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/tests/CMakeLists.txt;8;add_test;/root/repo/tests/CMakeLists.txt;31;nvsm_test;/root/repo/tests/CMakeLists.txt;0;")
@@ -0,0 +1,88 @@
+/**
+ * Paint time of a utilization graph with the cached background against
+ * redrawing the grid, labels and ring outlines on every repaint, which is
+ * what a font change forces. Runs without a display on the offscreen platform.
+ * Usage: paint_benchmark [iterations]
+ */
+
+#include <QApplication>
+#include <QEvent>
+#include <QPixmap>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+#include "settings.h"
+#include "utilization.h"
+
+#define GPUS 8
+#define ITERATIONS 500
+#define WIDTH 1600
+#define HEIGHT 400
+
+// the settings utilization.cpp reads, main.cpp is not linked
+uint UPDATE_DELAY = 500;
+uint GRAPH_LENGTH = 60000;
+QColor gpuColors[8] = {
+    _c(0, 255, 0),
+    _c(0, 0, 255),
+    _c(255, 0, 0),
+    _c(255, 255, 0),
+    _c(255, 0, 255),
+    _c(0, 255, 255),
+    _c(255, 255, 255),
+    _c(32, 32, 32)
+};
+
+template<typename F>
+static double measure(const int iterations, F &&paint) {
+    auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+        paint();
+    auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::micro>(end - begin).count() / iterations;
+}
+
+int main(int argc, char **argv) {
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QApplication app(argc, argv);
+
+    int iterations = argc > 1 ? atoi(argv[1]) : ITERATIONS;
+    if (iterations <= 0)
+        iterations = ITERATIONS;
+
+    // a full graph window of GPUs busy at different levels
+    GPUUtilizationWorker worker;
+    std::vector<GPUSample> gpus(GPUS);
+    long time = 0;
+    for (uint sample = 0; sample < GRAPH_POINTS; sample++, time += UPDATE_DELAY) {
+        for (int i = 0; i < GPUS; i++) {
+            gpus[i].name = "NVIDIA A100-SXM4-80GB";
+            gpus[i].uuid = "GPU-" + std::to_string(i);
+            gpus[i].utilization = (sample * (i + 1) * 7) % 101;
+        }
+        worker.addSample(time, gpus);
+    }
+
+    GPUUtilization widget(&worker);
+    widget.resize(WIDTH, HEIGHT);
+    QPixmap target(widget.size());
+
+    QEvent fontChange(QEvent::FontChange);
+    double full = measure(iterations, [&] {
+        widget.changeEvent(&fontChange); // background is redrawn
+        widget.render(&target);
+    });
+
+    double cached = measure(iterations, [&] { widget.render(&target); });
+
+    std::cout << GPUS << " GPUs, " << GRAPH_POINTS << " points each, " << WIDTH << "x" << HEIGHT << ", "
+              << iterations << " iterations\n";
+    std::cout << "background redrawn: " << full << " us/paint\n";
+    std::cout << "background cached:  " << cached << " us/paint\n";
+
+    return 0;
+}
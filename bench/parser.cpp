@@ -0,0 +1,198 @@
+/**
+ * Compares the string_view parser with the split()/streamline() parsing it
+ * replaced, using the original quadratic split() and streamline(), on a
+ * synthetic 8-GPU query and a 500-process pmon dump.
+ * Usage: parser_benchmark [iterations]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "constants.h"
+#include "parser.h"
+#include "utils.h"
+
+#define GPUS 8
+#define PROCESSES 500
+#define ITERATIONS 2000
+
+// the parsing before parser.h, with split() and streamline() as they were then: split() erases
+// every token from the front of its copy of the input, so a dump costs quadratic time
+namespace split_parser {
+
+static std::vector<std::string> split(std::string in, const std::string& delimiter) {
+    std::vector<std::string> out;
+    size_t pos = 0;
+    std::string token;
+    while ((pos = in.find(delimiter)) != std::string::npos) {
+        token = in.substr(0, pos);
+        out.push_back(token);
+        in.erase(0, pos + delimiter.length());
+    }
+    out.push_back(in);
+    return out;
+}
+
+static std::string streamline(const std::string& in) {
+    std::vector<std::string> lines = split(in, "\n");
+
+    Iterator it {};
+    for (std::string &line : lines) {
+        it = range(line, " ");
+        if (it.begin == 0) line.erase(0, it.end);
+        it.end = 0;
+
+        while ((it = range(line, " ", it.end)).begin != std::string::npos) {
+            if ((it.end - it.begin) > 1) {
+                line.erase(it.begin, it.end - it.begin - 1);
+                it.end = 0; // because we call erase
+            }
+        }
+    }
+
+    std::string s;
+    for (const std::string &line : lines)
+        s += line + "\n";
+
+    return s;
+}
+
+static void parseGPULine(const std::string &line, std::vector<GPUSample> &gpus) {
+    if (line.empty())
+        return;
+
+    std::vector<std::string> data = split(line, ", ");
+    if (data.size() < NVSMI_QUERY_COLUMNS)
+        return;
+
+    size_t index = atoi(data[NVSMI_QUERY_INDEX].c_str());
+    if (index >= gpus.size())
+        gpus.resize(index + 1);
+
+    GPUSample &gpu = gpus[index];
+    gpu.name = data[NVSMI_QUERY_NAME];
+    gpu.utilization = atoi(data[NVSMI_QUERY_GPU].c_str());
+    gpu.memoryUtilization = atoi(data[NVSMI_QUERY_MEM].c_str());
+    gpu.memoryTotal = atoi(data[NVSMI_QUERY_TOTAL].c_str());
+    gpu.memoryFree = atoi(data[NVSMI_QUERY_FREE].c_str());
+    gpu.memoryUsed = atoi(data[NVSMI_QUERY_USED].c_str());
+}
+
+static int parseValue(const std::string &value) {
+    return value == "-" ? NVSM_NA : atoi(value.c_str());
+}
+
+static bool parseProcess(const std::vector<std::string> &data, ProcessSample &process) {
+    if (data.size() < NVSMI_COLUMNS)
+        return false;
+
+    process.GPUIndex = atoi(data[NVSMI_GPUINDEX].c_str());
+    process.pid = parseValue(data[NVSMI_PID]);
+    process.type = data[NVSMI_TYPE];
+    process.name = data[NVSMI_NAME];
+    process.sm = parseValue(data[NVSMI_SM]);
+    process.mem = parseValue(data[NVSMI_MEM]);
+    process.enc = parseValue(data[NVSMI_ENC]);
+    process.dec = parseValue(data[NVSMI_DEC]);
+    process.fb = parseValue(data[NVSMI_FB]);
+
+    return true;
+}
+
+static void parse(const std::string &query, const std::string &pmon, std::vector<GPUSample> &gpus, std::vector<ProcessSample> &processes) {
+    gpus.clear();
+    for (const std::string &line : split(query, "\n"))
+        parseGPULine(line, gpus);
+
+    std::vector<std::string> lines = split(streamline(pmon), "\n");
+    processes.clear();
+
+    ProcessSample process;
+    for (size_t line = 2; line < lines.size(); line++) {
+        if (lines[line].empty())
+            continue;
+        if (parseProcess(split(lines[line], " "), process))
+            processes.push_back(process);
+    }
+}
+
+}
+
+namespace view_parser {
+
+static void parse(const std::string &query, const std::string &pmon, std::vector<GPUSample> &gpus, std::vector<ProcessSample> &processes) {
+    forEachLine(query, [&gpus](std::string_view line) { parseGPUQueryLine(line, gpus); });
+
+    size_t count = 0;
+    forEachLine(pmon, [&](std::string_view line) {
+        if (count == processes.size())
+            processes.emplace_back();
+        if (parsePmonLine(line, processes[count]))
+            count++;
+    });
+    processes.resize(count);
+}
+
+}
+
+static std::string queryOutput() {
+    std::string out;
+    for (int i = 0; i < GPUS; i++) {
+        out += std::to_string(i) + ", NVIDIA A100-SXM4-80GB, " + std::to_string(i * 11 % 100) + ", " +
+               std::to_string(i * 7 % 100) + ", 81920, 40960, 40960, GPU-" + std::to_string(10000000 + i) + "\n";
+    }
+    return out;
+}
+
+static std::string pmonOutput() {
+    std::string out = "# gpu        pid  type    fb    sm   mem   enc   dec   command\n"
+                      "# Idx          #   C/G    MB     %     %     %     %   name\n";
+    for (int i = 0; i < PROCESSES; i++) {
+        out += "    " + std::to_string(i % GPUS) + "    " + std::to_string(1000 + i) + "     C   " +
+               std::to_string(i * 13 % 4096) + "    " + std::to_string(i % 100) + "    " +
+               std::to_string(i * 3 % 100) + "     -     -   python" + std::to_string(i % 10) + "\n";
+    }
+    return out;
+}
+
+template<typename F>
+static double measure(const int iterations, F &&parse) {
+    auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+        parse();
+    auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::micro>(end - begin).count() / iterations;
+}
+
+int main(int argc, char **argv) {
+    int iterations = argc > 1 ? atoi(argv[1]) : ITERATIONS;
+    if (iterations <= 0)
+        iterations = ITERATIONS;
+
+    std::string query = queryOutput(), pmon = pmonOutput();
+    std::vector<GPUSample> gpus;
+    std::vector<ProcessSample> processes;
+
+    double splitTime = measure(iterations, [&] { split_parser::parse(query, pmon, gpus, processes); });
+    size_t splitCount = gpus.size() + processes.size();
+
+    gpus.clear();
+    processes.clear();
+    double viewTime = measure(iterations, [&] { view_parser::parse(query, pmon, gpus, processes); });
+    size_t viewCount = gpus.size() + processes.size();
+
+    if (splitCount != viewCount || gpus.size() != GPUS || processes.size() != PROCESSES) {
+        std::cout << "parsers disagree: " << splitCount << " vs " << viewCount << " rows\n";
+        return 1;
+    }
+
+    std::cout << GPUS << " GPUs, " << PROCESSES << " processes, " << iterations << " iterations\n";
+    std::cout << "split()/streamline(): " << splitTime << " us/sample\n";
+    std::cout << "string_view parser:   " << viewTime << " us/sample\n";
+
+    return 0;
+}
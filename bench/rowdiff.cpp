@@ -0,0 +1,82 @@
+/**
+ * Diffs a synthetic feed of 1000 processes, as the process table gets it:
+ * every tick a few processes exit, a few start and some change their values.
+ * Prints the diff time and how many rows the view is told about, against
+ * the 1000 rows a reset of the table touches.
+ * Usage: rowdiff_benchmark [ticks]
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "rowdiff.h"
+
+#define PROCESSES 1000
+#define GPUS 8
+#define TICKS 2000
+
+// what ProcessList compares, without the Qt parts
+struct Row {
+    int GPUIndex, pid;
+    int computeUse, memoryUse, vRAM;
+
+    uint64_t key() const { return (uint64_t) (uint32_t) GPUIndex << 32 | (uint32_t) pid; }
+
+    bool operator!=(const Row &other) const {
+        return key() != other.key() || computeUse != other.computeUse || memoryUse != other.memoryUse || vRAM != other.vRAM;
+    }
+};
+
+struct Counter {
+    unsigned long rows = 0;
+
+    void beginRemove(size_t first, size_t last) { rows += last - first + 1; }
+    void endRemove(size_t, size_t) {}
+    void kept(size_t, size_t, bool changed) { rows += changed; }
+    void beginInsert(size_t first, size_t last) { rows += last - first + 1; }
+    void inserted(size_t, size_t) {}
+    void endInsert() {}
+};
+
+int main(int argc, char **argv) {
+    int ticks = argc > 1 ? atoi(argv[1]) : TICKS;
+    if (ticks <= 0)
+        ticks = TICKS;
+
+    std::mt19937 random(1);
+    std::vector<Row> feed;
+    int nextPid = 1000;
+    for (int i = 0; i < PROCESSES; i++)
+        feed.push_back({i % GPUS, nextPid++, 50, 20, 1024});
+
+    std::vector<Row> rows;
+    Counter counter;
+    std::chrono::steady_clock::duration spent {};
+
+    for (int tick = 0; tick < ticks; tick++) {
+        // 1 % exit and are replaced, 10 % change
+        for (Row &row : feed) {
+            unsigned int dice = random() % 100;
+            if (dice == 0)
+                row = {(int) (random() % GPUS), nextPid++, 0, 0, 0};
+            else if (dice <= 10)
+                row.computeUse = random() % 101;
+        }
+
+        auto begin = std::chrono::steady_clock::now();
+        diffRows(rows, feed, counter);
+        spent += std::chrono::steady_clock::now() - begin;
+    }
+
+    double us = std::chrono::duration<double, std::micro>(spent).count() / ticks;
+
+    std::cout << PROCESSES << " processes, " << ticks << " ticks\n";
+    std::cout << "diff: " << us << " us/tick\n";
+    std::cout << "rows signalled: " << (double) counter.rows / ticks << " per tick, a reset touches " << PROCESSES << "\n";
+
+    return 0;
+}
@@ -0,0 +1,160 @@
+#include "accounting.h"
+#include "processlist.h"
+
+#include <algorithm>
+
+// processes that can not be seen in procfs, e.g. of another PID namespace
+#define UNKNOWN "(unknown)"
+
+void Accounting::update(const std::vector<ProcessList> &processes, const long time) {
+	generation++;
+
+	std::vector<Group*> previous[NVSM_GROUP_MODES];
+	for (int by = 0; by < NVSM_GROUP_MODES; by++)
+		previous[by].swap(active[by]);
+
+	for (const ProcessList &process : processes) {
+		if (process.pid == NVSM_NA) // pid unknown, can not be told apart from other processes
+			continue;
+
+		const ProcessIdentity *identity = process.host.identity.get();
+
+		Contribution next;
+		next.groups[ByUser] = group(ByUser, identity ? identity->user : UNKNOWN);
+		next.groups[ByCgroup] = group(ByCgroup, identity && !identity->cgroup.empty() ? identity->cgroup : UNKNOWN);
+		next.groups[ByContainer] = group(ByContainer, !identity ? UNKNOWN : identity->container.empty() ? "(host)" : identity->container);
+		next.computeUse = process.computeUse == NVSM_NA ? 0 : process.computeUse;
+		next.vRAM = process.vRAM == NVSM_NA ? 0 : process.vRAM;
+		next.generation = generation;
+
+		auto it = contributions.find(process.key());
+		if (it != contributions.end()) {
+			apply(it->second, -1);
+			it->second = next;
+		} else {
+			contributions.emplace(process.key(), next);
+		}
+
+		apply(next, 1);
+	}
+
+	for (auto it = contributions.begin(); it != contributions.end();) {
+		if (it->second.generation != generation) {
+			apply(it->second, -1);
+			it = contributions.erase(it);
+		} else {
+			++it;
+		}
+	}
+
+	// the groups of the previous sample without processes now
+	for (int by = 0; by < NVSM_GROUP_MODES; by++) {
+		for (Group *group : previous[by]) {
+			if (group->generation != generation) {
+				group->idle = true;
+				idleChanged[by] = true;
+			}
+		}
+	}
+
+	// pmon reports the use over the interval that just ended
+	long interval = lastTime > 0 ? time - lastTime : 0;
+	lastTime = time;
+	if (interval < 0 || interval > NVSM_ACCOUNTING_MAX_GAP)
+		interval = 0;
+
+	for (auto &mode : active) {
+		for (Group *group : mode) {
+			group->usage.GPUSeconds += group->usage.computeUse / 100.0 * interval / 1000.0;
+			group->usage.lastActive = time;
+		}
+	}
+
+	expire();
+
+	// idle groups do not change, the list is rebuilt only when groups went idle, active or away
+	for (int by = 0; by < NVSM_GROUP_MODES; by++) {
+		if (!idleChanged[by])
+			continue;
+
+		auto list = std::make_shared<std::vector<GroupUsage>>();
+		for (const auto &entry : groups[by])
+			if (entry.second.idle)
+				list->push_back(entry.second.usage);
+
+		idle[by] = std::move(list);
+		idleChanged[by] = false;
+	}
+}
+
+GroupsData Accounting::get(const GroupBy by) const {
+	GroupsData result;
+	if (idle[by])
+		result.idle = idle[by];
+
+	result.active.reserve(active[by].size());
+	for (const Group *group : active[by])
+		result.active.push_back(group->usage);
+
+	return result;
+}
+
+// marks the group as having processes in this sample
+Accounting::Group* Accounting::group(const GroupBy by, const std::string &name) {
+	auto it = groups[by].find(name);
+	if (it == groups[by].end()) {
+		it = groups[by].emplace(name, Group()).first;
+		it->second.usage.name = name;
+	}
+
+	Group &group = it->second;
+	if (group.generation != generation) {
+		group.generation = generation;
+		active[by].push_back(&group);
+
+		if (group.idle) {
+			group.idle = false;
+			idleChanged[by] = true;
+		}
+	}
+
+	return &group;
+}
+
+void Accounting::apply(const Contribution &contribution, const int sign) {
+	for (Group *group : contribution.groups) {
+		group->usage.processes += sign;
+		group->usage.computeUse += sign * contribution.computeUse;
+		group->usage.vRAM += sign * contribution.vRAM;
+	}
+}
+
+// only idle groups can go, no contribution points to them
+void Accounting::expire() {
+	for (int by = 0; by < NVSM_GROUP_MODES; by++) {
+		auto &mode = groups[by];
+		if (mode.size() <= NVSM_ACCOUNTING_GROUPS_MAX)
+			continue;
+
+		std::vector<long> lastActive;
+		for (const auto &entry : mode)
+			if (entry.second.idle)
+				lastActive.push_back(entry.second.usage.lastActive);
+
+		size_t excess = std::min(mode.size() - NVSM_ACCOUNTING_GROUPS_MAX, lastActive.size());
+		if (excess == 0)
+			continue;
+
+		std::nth_element(lastActive.begin(), lastActive.begin() + excess - 1, lastActive.end());
+		long cutoff = lastActive[excess - 1];
+
+		for (auto it = mode.begin(); it != mode.end();) {
+			if (it->second.idle && it->second.usage.lastActive <= cutoff) {
+				it = mode.erase(it);
+				idleChanged[by] = true;
+			} else {
+				++it;
+			}
+		}
+	}
+}
@@ -0,0 +1,83 @@
+#ifndef ACCOUNTING_H
+#define ACCOUNTING_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "constants.h"
+
+struct ProcessList;
+
+enum GroupBy : uint8_t {
+	ByUser, ByCgroup, ByContainer
+};
+
+struct GroupUsage {
+	std::string name;
+	int processes = 0; // a process using several GPUs counts once per GPU
+	int computeUse = 0; // %, summed over the processes and GPUs of the group
+	long vRAM = 0; // MiB
+	double GPUSeconds = 0; // compute use integrated over time: 100 % for 1 s is 1
+	long lastActive = 0; // ms, the last sample the group had processes in
+
+	// what the accounting table shows; lastActive moves with every sample of an active group, it is not shown
+	bool operator==(const GroupUsage &other) const {
+		return name == other.name && processes == other.processes && computeUse == other.computeUse &&
+			vRAM == other.vRAM && GPUSeconds == other.GPUSeconds;
+	}
+	bool operator!=(const GroupUsage &other) const { return !(*this == other); }
+
+	// rows of the accounting table are matched by name
+	std::string key() const { return name; }
+};
+
+// the groups of one GroupBy; idle groups do not change, a snapshot shares them with the previous one
+struct GroupsData {
+	std::shared_ptr<const std::vector<GroupUsage>> idle = std::make_shared<const std::vector<GroupUsage>>(); // no processes
+	std::vector<GroupUsage> active; // with processes in the last sample
+};
+
+/**
+ * Usage per user, cgroup and container. Every process remembers what it
+ * added to its groups, so a sample only takes back the old values of the
+ * processes it contains and adds the new ones, instead of summing all
+ * groups again, and only the groups of these processes are integrated.
+ * Groups stay after their processes are gone to keep their GPU-seconds,
+ * the least recently active are dropped above NVSM_ACCOUNTING_GROUPS_MAX
+ */
+class Accounting {
+public:
+	void update(const std::vector<ProcessList> &processes, long time);
+
+	// copies only the active groups
+	GroupsData get(GroupBy by) const;
+
+private:
+	struct Group {
+		GroupUsage usage;
+		uint32_t generation = 0; // of the last sample the group had processes in
+		bool idle = false; // in idle
+	};
+
+	struct Contribution {
+		Group *groups[NVSM_GROUP_MODES]; // nodes of groups, they do not move
+		int computeUse, vRAM;
+		uint32_t generation; // of the last sample the process was in
+	};
+
+	std::unordered_map<std::string, Group> groups[NVSM_GROUP_MODES];
+	std::vector<Group*> active[NVSM_GROUP_MODES]; // groups with processes in the last sample
+	std::shared_ptr<const std::vector<GroupUsage>> idle[NVSM_GROUP_MODES]; // all other groups
+	bool idleChanged[NVSM_GROUP_MODES] = {};
+	std::unordered_map<uint64_t, Contribution> contributions; // ProcessList::key() -> contribution
+	uint32_t generation = 0;
+	long lastTime = 0;
+
+	Group* group(GroupBy by, const std::string &name);
+	static void apply(const Contribution &contribution, int sign);
+	void expire();
+};
+
+#endif
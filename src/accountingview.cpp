@@ -0,0 +1,113 @@
+#include "accountingview.h"
+#include <QHeaderView>
+#include <QVBoxLayout>
+#include "processesworker.h"
+#include "rowdiff.h"
+#include "utils.h"
+
+GroupsModel::GroupsModel(QObject *parent) : QAbstractTableModel(parent) {}
+
+int GroupsModel::rowCount(const QModelIndex &parent) const {
+	return parent.isValid() ? 0 : rows.size();
+}
+
+int GroupsModel::columnCount(const QModelIndex &parent) const {
+	return parent.isValid() ? 0 : NVSM_GROUP_COLUMNS;
+}
+
+QVariant GroupsModel::data(const QModelIndex &index, int role) const {
+	if (role != Qt::DisplayRole || !index.isValid() || index.row() >= (int) rows.size())
+		return QVariant();
+
+	const GroupUsage &group = rows[index.row()];
+
+	switch (index.column()) {
+		case NVSM_GROUP_NAME: return QString(group.name.c_str());
+		case NVSM_GROUP_PROCESSES: return QString::number(group.processes);
+		case NVSM_GROUP_SM: return QString::number(group.computeUse) + " %";
+		case NVSM_GROUP_MEM: return QString::number((qlonglong) group.vRAM) + " MB";
+		case NVSM_GROUP_SECONDS: return QString(toString(group.GPUSeconds).c_str());
+		default: return QVariant();
+	}
+}
+
+QVariant GroupsModel::headerData(int section, Qt::Orientation orientation, int role) const {
+	static const char *titles[NVSM_GROUP_COLUMNS] = {
+		"Group", "Processes", "Compute Use", "GPU Memory Use", "GPU Seconds"
+	};
+
+	if (role != Qt::DisplayRole || orientation != Qt::Horizontal || section < 0 || section >= NVSM_GROUP_COLUMNS)
+		return QVariant();
+
+	return QString(titles[section]);
+}
+
+void GroupsModel::update(const GroupsData &data) {
+	std::vector<GroupUsage> groups;
+	groups.reserve(data.idle->size() + data.active.size());
+	groups.insert(groups.end(), data.idle->begin(), data.idle->end());
+	groups.insert(groups.end(), data.active.begin(), data.active.end());
+
+	// the model side of diffRows(); GPU-seconds only grow while a group has processes, idle groups are not repainted
+	struct Listener {
+		GroupsModel *model;
+
+		void beginRemove(size_t first, size_t last) { model->beginRemoveRows(QModelIndex(), first, last); }
+		void endRemove(size_t, size_t) { model->endRemoveRows(); }
+
+		void kept(size_t row, size_t, bool changed) {
+			if (changed)
+				model->dataChanged(model->index(row, 0), model->index(row, NVSM_GROUP_COLUMNS - 1));
+		}
+
+		void beginInsert(size_t first, size_t last) { model->beginInsertRows(QModelIndex(), first, last); }
+		void inserted(size_t, size_t) {}
+		void endInsert() { model->endInsertRows(); }
+	} listener {this};
+
+	diffRows(rows, groups, listener);
+}
+
+void GroupsModel::clear() {
+	beginResetModel();
+	rows.clear();
+	endResetModel();
+}
+
+AccountingView::AccountingView(ProcessesWorker *worker, QWidget *parent) : QWidget(parent) {
+	this->worker = worker;
+
+	groupBy = new QComboBox;
+	groupBy->addItem("Group by user", ByUser);
+	groupBy->addItem("Group by cgroup", ByCgroup);
+	groupBy->addItem("Group by container", ByContainer);
+
+	groupsModel = new GroupsModel(this);
+	table = new QTableView;
+	table->setModel(groupsModel);
+	table->setSelectionBehavior(QAbstractItemView::SelectRows);
+	table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+	table->verticalHeader()->hide();
+	table->setAutoScroll(false);
+
+	auto *layout = new QVBoxLayout;
+	layout->addWidget(groupBy);
+	layout->addWidget(table);
+	setLayout(layout);
+
+	// the rows of another grouping have nothing in common with the current ones
+	connect(groupBy, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this](int) {
+		groupsModel->clear();
+		onDataUpdated();
+	});
+}
+
+void AccountingView::onDataUpdated() {
+	std::shared_ptr<const ProcessesData> data = worker->data.load();
+	size_t rows = groupsModel->rows.size();
+
+	groupsModel->update(data->groups[groupBy->currentData().toInt()]);
+
+	if (groupsModel->rows.size() > rows)
+		table->resizeColumnsToContents();
+}
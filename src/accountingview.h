@@ -0,0 +1,47 @@
+#ifndef ACCOUNTINGVIEW_H
+#define ACCOUNTINGVIEW_H
+
+#include <QWidget>
+#include <QTableView>
+#include <QAbstractTableModel>
+#include <QComboBox>
+#include "accounting.h"
+
+class ProcessesWorker;
+
+/**
+ * Rows of the accounting table, diffed by group name like ProcessesModel
+ */
+class GroupsModel : public QAbstractTableModel {
+	Q_OBJECT
+public:
+	std::vector<GroupUsage> rows;
+
+	explicit GroupsModel(QObject *parent = nullptr);
+
+	int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+	int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+	QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+	QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+	void update(const GroupsData &data);
+	void clear();
+};
+
+class AccountingView : public QWidget {
+	Q_OBJECT
+public:
+	ProcessesWorker *worker;
+
+	explicit AccountingView(ProcessesWorker *worker, QWidget *parent = nullptr);
+
+private:
+	QComboBox *groupBy;
+	QTableView *table;
+	GroupsModel *groupsModel;
+
+public slots:
+	void onDataUpdated();
+};
+
+#endif
@@ -0,0 +1,234 @@
+#include "alerts.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+#include "constants.h"
+#include "topology.h"
+#include "utils.h"
+
+#define METRICS (sizeof(metricNames) / sizeof(metricNames[0]))
+
+static const char *metricNames[] = {"utilization", "memory", "memoryUsed", "memoryUtilization", "processes"};
+static const char *metricUnits[] = {" %", " %", " MiB", " %", ""};
+
+static double available(const int value) {
+    return value == NVSM_NA ? NAN : value;
+}
+
+// NAN if the source does not report it
+static double value(const AlertMetric metric, const GPUSample &gpu, const int processes) {
+    switch (metric) {
+        case AlertUtilization: return available(gpu.utilization);
+        case AlertMemory: return gpu.memoryTotal > 0 && gpu.memoryUsed != NVSM_NA ? gpu.memoryUsed * 100.0 / gpu.memoryTotal : NAN;
+        case AlertMemoryUsed: return available(gpu.memoryUsed);
+        case AlertMemoryUtilization: return available(gpu.memoryUtilization);
+        case AlertProcesses: return available(processes);
+    }
+
+    return NAN;
+}
+
+// an unknown value holds no condition, a pending alert starts over
+static bool holds(const AlertCondition &condition, const double value) {
+    if (std::isnan(value))
+        return false;
+    if (condition.above)
+        return condition.inclusive ? value >= condition.threshold : value > condition.threshold;
+    return condition.inclusive ? value <= condition.threshold : value < condition.threshold;
+}
+
+// a firing alert only resolves once the value is clearly on the other side
+// an unknown value does not resolve it either, a source that stops reporting can not end an alert
+static bool clears(const AlertCondition &condition, const double value, const double hysteresis) {
+    if (std::isnan(value))
+        return false;
+    return condition.above ? value < condition.threshold - hysteresis : value > condition.threshold + hysteresis;
+}
+
+static void replace(std::string &s, const std::string &key, const std::string &value) {
+    for (size_t pos = 0; (pos = s.find(key, pos)) != std::string::npos; pos += value.size())
+        s.replace(pos, key.size(), value);
+}
+
+std::vector<int> countProcesses(const std::vector<ProcessSample> &processes, const size_t gpus) {
+    std::vector<int> counts(gpus, 0);
+    for (const ProcessSample &process : processes)
+        if (process.pid != NVSM_NA && process.GPUIndex >= 0 && (size_t) process.GPUIndex < gpus)
+            counts[process.GPUIndex]++;
+
+    return counts;
+}
+
+std::string AlertEvent::message() const {
+    const AlertCondition &condition = rule->conditions.front();
+    return rule->name + " " + (firing ? "firing" : "resolved") + " on GPU " + std::to_string(GPU) + " (" + gpuName + "): " +
+            metricNames[condition.metric] + " " + (std::isnan(value) ? "-" : toString(value)) + metricUnits[condition.metric];
+}
+
+// ${NAME} expands the same unquoted and within double quotes, and its value is not parsed again
+std::string AlertEvent::command() const {
+    std::string command = rule->command;
+    replace(command, "{rule}", "${" NVSM_ENV_ALERT_RULE "}");
+    replace(command, "{gpu}", "${" NVSM_ENV_GPU_INDEX "}");
+    replace(command, "{name}", "${" NVSM_ENV_GPU_NAME "}");
+    replace(command, "{value}", "${" NVSM_ENV_ALERT_VALUE "}");
+    replace(command, "{state}", "${" NVSM_ENV_ALERT_STATE "}");
+    return command;
+}
+
+std::vector<std::pair<std::string, std::string>> AlertEvent::environment() const {
+    return {
+        {NVSM_ENV_ALERT_RULE, rule->name},
+        {NVSM_ENV_GPU_INDEX, std::to_string(GPU)},
+        {NVSM_ENV_GPU_NAME, gpuName},
+        {NVSM_ENV_ALERT_VALUE, std::isnan(value) ? "-" : toString(value)},
+        {NVSM_ENV_ALERT_STATE, firing ? "firing" : "resolved"}
+    };
+}
+
+AlertEngine::AlertEngine(std::function<void(const AlertEvent&)> handler): handler(std::move(handler)) {}
+
+bool AlertEngine::add(const std::string &line) {
+    std::string rule = streamline(line);
+    rule.pop_back(); // streamline() terminates the line with '\n'
+
+    // the command takes the rest of the line, spaces included
+    std::string command;
+    size_t execPos = rule.find(" exec ");
+    if (execPos != std::string::npos) {
+        command = rule.substr(execPos + 6);
+        rule.erase(execPos + 5);
+    }
+
+    std::vector<std::string> tokens = split(rule, " ");
+    auto error = [&](const std::string &message) {
+        std::cout << "Invalid alert rule \"" << line << "\": " << message << "\n";
+        return false;
+    };
+
+    if (tokens.size() < 5)
+        return error("expected alert <name> <metric> <op> <threshold> ...");
+
+    AlertRule result;
+    result.name = tokens[1];
+
+    size_t i = 2;
+    while (true) {
+        if (i + 3 > tokens.size())
+            return error("incomplete condition");
+
+        AlertCondition condition;
+        size_t metric = 0;
+        while (metric < METRICS && tokens[i] != metricNames[metric])
+            metric++;
+        if (metric == METRICS)
+            return error("unknown metric " + tokens[i]);
+        condition.metric = (AlertMetric) metric;
+
+        const std::string &op = tokens[i + 1];
+        if (op != ">" && op != ">=" && op != "<" && op != "<=")
+            return error("unknown operator " + op);
+        condition.above = op[0] == '>';
+        condition.inclusive = op.size() == 2;
+        condition.threshold = atof(tokens[i + 2].c_str());
+
+        result.conditions.push_back(condition);
+        i += 3;
+
+        if (i == tokens.size() || tokens[i] != "and")
+            break;
+        i++;
+    }
+
+    for (; i < tokens.size(); i++) {
+        const std::string &token = tokens[i];
+
+        if (token == "for" && i + 1 < tokens.size()) {
+            result.duration = atol(tokens[++i].c_str());
+        } else if (token == "hysteresis" && i + 1 < tokens.size()) {
+            result.hysteresis = atof(tokens[++i].c_str());
+        } else if (token == "log") {
+            result.action = AlertLog;
+        } else if (token == "notify") {
+            result.action = AlertNotify;
+        } else if (token == "exec" && !command.empty()) {
+            result.action = AlertExec;
+            result.command = command;
+        } else {
+            return error("unexpected " + token);
+        }
+    }
+
+    rules.push_back(result);
+    states.emplace_back();
+
+    return true;
+}
+
+bool AlertEngine::needsProcesses() const {
+    for (const AlertRule &rule : rules)
+        for (const AlertCondition &condition : rule.conditions)
+            if (condition.metric == AlertProcesses)
+                return true;
+
+    return false;
+}
+
+void AlertEngine::evaluate(const long time, const std::vector<GPUSample> &gpus, const std::vector<int> &processes) {
+    generation++;
+    keys.resize(gpus.size());
+    for (size_t GPU = 0; GPU < gpus.size(); GPU++)
+        keys[GPU] = gpuKey(gpus[GPU], GPU);
+
+    for (size_t r = 0; r < rules.size(); r++) {
+        const AlertRule &rule = rules[r];
+        std::unordered_map<std::string, State> &gpuStates = states[r];
+
+        for (size_t GPU = 0; GPU < gpus.size(); GPU++) {
+            State &state = gpuStates[keys[GPU]];
+            state.generation = generation;
+
+            int count = GPU < processes.size() ? processes[GPU] : NVSM_NA;
+            bool all = true, cleared = false;
+            for (const AlertCondition &condition : rule.conditions) {
+                double v = value(condition.metric, gpus[GPU], count);
+                all = all && holds(condition, v);
+                cleared = cleared || clears(condition, v, rule.hysteresis);
+            }
+
+            if (state.firing) {
+                if (cleared) {
+                    state.firing = false;
+                    state.pendingSince = -1;
+                    fire(rule, GPU, gpus[GPU], value(rule.conditions.front().metric, gpus[GPU], count), false);
+                }
+            } else if (!all) {
+                state.pendingSince = -1;
+            } else {
+                if (state.pendingSince == -1)
+                    state.pendingSince = time;
+
+                if (time - state.pendingSince >= rule.duration) {
+                    state.firing = true;
+                    fire(rule, GPU, gpus[GPU], value(rule.conditions.front().metric, gpus[GPU], count), true);
+                }
+            }
+        }
+
+        // GPUs that fell off the bus
+        if (gpuStates.size() > gpus.size()) {
+            for (auto it = gpuStates.begin(); it != gpuStates.end();) {
+                if (it->second.generation != generation)
+                    it = gpuStates.erase(it);
+                else
+                    ++it;
+            }
+        }
+    }
+}
+
+void AlertEngine::fire(const AlertRule &rule, const int GPU, const GPUSample &gpu, const double v, const bool firing) const {
+    handler({&rule, GPU, gpu.name, v, firing});
+}
@@ -0,0 +1,106 @@
+#ifndef ALERTS_H
+#define ALERTS_H
+
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "source.h"
+
+enum AlertMetric {
+    AlertUtilization, // %
+    AlertMemory, // % of memory used
+    AlertMemoryUsed, // MiB
+    AlertMemoryUtilization, // % of time the memory controller was busy
+    AlertProcesses // processes using the GPU
+};
+
+enum AlertAction {
+    AlertLog, AlertNotify, AlertExec
+};
+
+struct AlertCondition {
+    AlertMetric metric;
+    bool above; // > or >=, otherwise < or <=
+    bool inclusive; // >= or <=
+    double threshold;
+};
+
+struct AlertRule {
+    std::string name;
+    std::vector<AlertCondition> conditions; // all must hold
+    long duration = 0; // ms the conditions must hold before the alert fires
+    double hysteresis = 0; // a firing alert resolves only when a condition misses its threshold by this much
+    AlertAction action = AlertLog;
+    std::string command; // for AlertExec, {rule} {gpu} {name} {value} {state} are replaced
+};
+
+// an alert of one GPU that fired or resolved
+struct AlertEvent {
+    const AlertRule *rule; // valid while the handler runs
+    int GPU;
+    std::string gpuName;
+    double value; // of the first condition, NAN if the source does not report it
+    bool firing; // otherwise resolved
+
+    // "<rule> firing on GPU <index> (<name>): <metric> <value>"
+    std::string message() const;
+
+    // the exec command of the rule for sh -c; the placeholders become references to the variables
+    // of environment(), so the shell never parses a value, e.g. a GPU name, as part of the command
+    std::string command() const;
+
+    std::vector<std::pair<std::string, std::string>> environment() const;
+};
+
+// processes per GPU index in a process sample; a row without a pid, like the one pmon prints
+// for an idle GPU, is not a process
+std::vector<int> countProcesses(const std::vector<ProcessSample> &processes, size_t gpus);
+
+/**
+ * Evaluates threshold rules on every GPU sample:
+ *
+ *   alert <name> <metric> <op> <threshold> [and <metric> <op> <threshold>]...
+ *         [for <ms>] [hysteresis <value>] <log | notify | exec <command>>
+ *
+ * metric is utilization, memory, memoryUsed, memoryUtilization or processes,
+ * op is >, >=, < or <=. A condition on a value the source does not report
+ * neither holds nor clears. Every rule keeps only its state per GPU, keyed
+ * by gpuKey() so it follows a GPU whose index changed, and a sample costs
+ * the same however long the rule has been pending
+ */
+class AlertEngine {
+public:
+    // handler runs the action of every event, on the thread of evaluate(), so it must not wait for it
+    explicit AlertEngine(std::function<void(const AlertEvent &event)> handler);
+
+    // returns false and logs the reason if the line is not a valid rule
+    bool add(const std::string &line);
+
+    bool empty() const { return rules.empty(); }
+
+    // whether a rule uses the processes metric
+    bool needsProcesses() const;
+
+    // processes - count per GPU index, NVSM_NA where it is not known
+    void evaluate(long time, const std::vector<GPUSample> &gpus, const std::vector<int> &processes);
+
+private:
+    struct State {
+        long pendingSince = -1; // time the conditions started to hold, -1 - they do not
+        bool firing = false;
+        unsigned long generation; // of the last evaluate() the GPU was in
+    };
+
+    std::function<void(const AlertEvent &event)> handler;
+    std::vector<AlertRule> rules;
+    std::vector<std::unordered_map<std::string, State>> states; // [rule][gpuKey()]
+    std::vector<std::string> keys; // of the GPUs being evaluated
+    unsigned long generation = 0; // counts evaluate()
+
+    void fire(const AlertRule &rule, int GPU, const GPUSample &gpu, double value, bool firing) const;
+};
+
+#endif
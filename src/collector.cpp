@@ -0,0 +1,151 @@
+#include "collector.h"
+
+#include <QProcess>
+#include <QProcessEnvironment>
+#include <QStringList>
+#include <iostream>
+
+#include "settings.h"
+#include "utils.h"
+
+// processes per GPU index in the latest process sample, NVSM_NA while there is none or it is stale
+static std::vector<int> processCounts(const ProcessesData &data, const size_t gpus) {
+    if (data.time == 0 || data.stale)
+        return std::vector<int>(gpus, NVSM_NA);
+
+    return countProcesses(data.samples, gpus);
+}
+
+// hooks and notifications are started detached, the collector thread never waits for them
+static void runAlert(const AlertEvent &event) {
+    std::string state = event.firing ? "firing" : "resolved";
+
+    switch (event.rule->action) {
+        case AlertLog:
+            std::cout << "Alert " << event.message() << "\n";
+            break;
+        case AlertNotify:
+            QProcess::startDetached(NVSM_NOTIFY_COMMAND, QStringList() << NVSM_NOTIFY_APP_NAME
+                    << ("Alert " + event.rule->name + " " + state).c_str() << event.message().c_str());
+            break;
+        case AlertExec: {
+            QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+            for (const auto &variable : event.environment())
+                environment.insert(variable.first.c_str(), variable.second.c_str());
+
+            QProcess process;
+            process.setProgram(NVSM_SHELL);
+            process.setArguments(QStringList() << "-c" << event.command().c_str());
+            process.setProcessEnvironment(environment);
+            process.startDetached();
+            break;
+        }
+    }
+}
+
+Collector::Collector(MetricsSource *source) {
+    workerThread = new WorkerThread(source);
+    processes = new ProcessesWorker;
+    gpuUtilization = new GPUUtilizationWorker;
+    memoryUtilization = new MemoryUtilizationWorker;
+
+    GPUSampler *sampler = &workerThread->sampler;
+    processes->sampler = sampler;
+    gpuUtilization->sampler = sampler;
+    memoryUtilization->sampler = sampler;
+
+    if (!RECORD_PATH.empty())
+        recorder = new Recorder(RECORD_PATH);
+
+    if (!ALERT_RULES.empty()) {
+        alerts = new AlertEngine(runAlert);
+        for (const std::string &rule : ALERT_RULES)
+            alerts->add(rule);
+
+        if (alerts->empty()) {
+            delete alerts;
+            alerts = nullptr;
+        }
+    }
+
+    gpuInterval = UPDATE_DELAY;
+    processesInterval = PROCESSES_INTERVAL;
+
+    // both graphs are fed by one GPU sample, pmon runs on its own interval;
+    // a paused task stops the streams of the source
+    gpuTask = workerThread->addTask(UPDATE_DELAY, [=]() {
+        uint interval = workerThread->getInterval(gpuTask);
+        if (interval != gpuInterval) {
+            gpuInterval = interval;
+            sampler->source->setGPUInterval(interval);
+        }
+
+        sampler->sample();
+
+        // a failed sample repeats the last values, they are neither recorded again nor alerted on
+        if (!sampler->stale) {
+            if (recorder)
+                recorder->push(getTime(), sampler->gpus);
+            if (alerts) {
+                std::vector<int> counts;
+                if (alerts->needsProcesses())
+                    counts = processCounts(*processes->data.load(), sampler->gpus.size());
+                alerts->evaluate(getTime(), sampler->gpus, counts);
+            }
+        }
+        gpuUtilization->work();
+        memoryUtilization->work();
+    }, [=]() {
+        gpuInterval = 0;
+        sampler->source->setGPUInterval(0);
+    });
+    processesTask = workerThread->addTask(PROCESSES_INTERVAL, [=]() {
+        uint interval = workerThread->getInterval(processesTask);
+        if (interval != processesInterval) {
+            processesInterval = interval;
+            sampler->source->setProcessesInterval(interval);
+            processes->setInterval(interval);
+        }
+
+        processes->work();
+    }, [=]() {
+        processesInterval = 0;
+        sampler->source->setProcessesInterval(0);
+        processes->setInterval(0);
+    });
+}
+
+Collector::~Collector() {
+    stop();
+    delete workerThread;
+    delete processes;
+    delete gpuUtilization;
+    delete memoryUtilization;
+    delete recorder;
+    delete alerts;
+}
+
+void Collector::start() {
+    workerThread->start();
+    if (recorder)
+        recorder->start();
+}
+
+void Collector::refresh() {
+    workerThread->refresh();
+}
+
+void Collector::setVisible(const bool graphs, const bool processes) {
+    // the recorder and the alerts see every GPU sample, /metrics serves both
+    bool gpusNeeded = graphs || exported || recorder || alerts;
+    bool processesNeeded = processes || exported || (alerts && alerts->needsProcesses());
+    workerThread->setInterval(gpuTask, gpusNeeded ? UPDATE_DELAY : BACKGROUND_INTERVAL(UPDATE_DELAY));
+    workerThread->setInterval(processesTask, processesNeeded ? PROCESSES_INTERVAL : BACKGROUND_INTERVAL(PROCESSES_INTERVAL));
+}
+
+void Collector::stop() {
+    workerThread->stop();
+    workerThread->wait(); // for the workers that are still sampling
+    if (recorder)
+        recorder->stop(); // writes what is left
+}
@@ -0,0 +1,43 @@
+#ifndef COLLECTOR_H
+#define COLLECTOR_H
+
+#include "worker.h"
+#include "processesworker.h"
+#include "utilization.h"
+#include "recorder.h"
+#include "alerts.h"
+
+/**
+ * Owns the workers and the thread that schedules them. It does not need
+ * any widget, so it runs the same way in the GUI and in headless mode
+ */
+class Collector {
+public:
+    WorkerThread *workerThread;
+    ProcessesWorker *processes;
+    GPUUtilizationWorker *gpuUtilization;
+    MemoryUtilizationWorker *memoryUtilization;
+    Recorder *recorder = nullptr; // if RECORD_PATH is set
+    AlertEngine *alerts = nullptr; // if there are valid ALERT_RULES
+    bool exported = false; // samples are served, e.g. on /metrics, they are needed at full rate
+    size_t gpuTask, processesTask; // of workerThread
+
+    explicit Collector(MetricsSource *source); // takes ownership of source
+    ~Collector();
+
+    void start();
+    void stop(); // blocks until all workers are done
+
+    // samples everything now instead of at the next deadlines
+    void refresh();
+
+    // whether the graphs / the processes can be seen; the sources of hidden ones drop to
+    // BACKGROUND_INTERVAL unless something else needs them, and catch up once shown again
+    void setVisible(bool graphs, bool processes);
+
+private:
+    // applied to the source, each only touched by its task
+    uint gpuInterval, processesInterval;
+};
+
+#endif
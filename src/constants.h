@@ -3,13 +3,48 @@
 
 #define NVSM_CONF_UPDATE_DELAY "updateDelay"
 #define NVSM_CONF_GRAPH_LENGTH "graphLength"
+#define NVSM_CONF_PROCESSES_DELAY "processesDelay"
 #define NVSM_CONF_GCOLOR "gpuColor"
+#define NVSM_CONF_STREAMING "streaming"
+#define NVSM_CONF_SOURCE "source"
+#define NVSM_CONF_NVML_LIBRARY "nvmlLibrary"
+#define NVSM_CONF_METRICS_PORT "metricsPort"
+#define NVSM_CONF_RECORD "record"
+#define NVSM_CONF_PROC_ROOT "procRoot"
+#define NVSM_CONF_ALERT "alert"
+#define NVSM_CONF_FLEET_HOST "fleetHost"
+#define NVSM_CONF_FLEET_COMMAND "fleetCommand"
+#define NVSM_CONF_FLEET_DELAY "fleetDelay"
+#define NVSM_CONF_FLEET_TIMEOUT "fleetTimeout"
+#define NVSM_CONF_BACKGROUND_DELAY "backgroundDelay"
+
+// values of NVSM_CONF_SOURCE
+#define NVSM_SOURCE_AUTO "auto"
+#define NVSM_SOURCE_NVML "nvml"
+#define NVSM_SOURCE_NVIDIA_SMI "nvidia-smi"
+
+#define NVML_LIBRARY_DEFAULT "libnvidia-ml.so.1"
 
 #define NVSMI_CMD_GPU_COUNT "nvidia-smi --query-gpu=count --format=csv"
 #define NVSMI_CMD_PROCESSES "nvidia-smi pmon -c 1 -s mu"
-#define NVSMI_CMD_GPU_UTILIZATION "nvidia-smi --query-gpu=utilization.gpu --format=csv"
-#define NVSMI_CMD_MEM_UTILIZATION "nvidia-smi --query-gpu=utilization.memory,memory.total,memory.free,memory.used --format=csv"
-#define NVSMI_LIST_GPUS "nvidia-smi --query-gpu=gpu_name --format=csv"
+#define NVSMI_CMD_GPU_QUERY "nvidia-smi --query-gpu=index,name,utilization.gpu,utilization.memory,memory.total,memory.free,memory.used,uuid --format=csv,noheader,nounits"
+
+// streaming variants, the interval is appended at runtime
+#define NVSMI_CMD_PROCESSES_STREAM "nvidia-smi pmon -s mu -o T -d " // seconds
+#define NVSMI_CMD_GPU_QUERY_STREAM NVSMI_CMD_GPU_QUERY " --loop-ms=" // milliseconds
+#define NVSM_PMON_DELAY_MAX 10 // s, the longest pmon -d accepts
+
+// nvidia-smi gpu query output indices
+#define NVSMI_QUERY_INDEX   0
+#define NVSMI_QUERY_NAME    1
+#define NVSMI_QUERY_GPU     2
+#define NVSMI_QUERY_MEM     3
+#define NVSMI_QUERY_TOTAL   4
+#define NVSMI_QUERY_FREE    5
+#define NVSMI_QUERY_USED    6
+#define NVSMI_QUERY_COLUMNS 7 // required, older collectors and fleet commands may print no uuid
+#define NVSMI_QUERY_UUID    7
+#define NVSM_GPUS_MAX 1024 // higher indexes are taken for garbage
 
 // nvidia-smi command output indices
 #define NVSMI_GPUINDEX	0
@@ -21,6 +56,8 @@
 #define NVSMI_ENC    	6
 #define NVSMI_DEC    	7
 #define NVSMI_NAME   	8
+#define NVSMI_COLUMNS   9
+#define NVSMI_STREAM_TIME 0 // `pmon -o T` prepends a time column
 
 // nvidia-system-monitor processes columns
 #define NVSM_GPUIDX 2
@@ -31,12 +68,105 @@
 #define NVSM_ENC    6
 #define NVSM_DEC    7
 #define NVSM_NAME   0
+#define NVSM_USER   8
+#define NVSM_CPU    9
+#define NVSM_RSS    10
+#define NVSM_CONTAINER 11
+#define NVSM_TREND  12
+#define NVSM_COLUMNS 13
 
 #define GRAPTH_OFFSET               32
 #define STATUS_OBJECT_OFFSET        16
 #define STATUS_OBJECT_TEXT_OFFSET   16
 
-#define NVSM_WORKERS_MAX 3
+// graph history: raw points, then min / avg / max buckets of these widths in ms
+#define NVSM_HISTORY_RAW_POINTS 65536
+#define NVSM_HISTORY_RESOLUTIONS {10000, 60000, 600000}
+#define NVSM_HISTORY_TIER_POINTS 4096
+#define NVSM_HISTORY_POINTS_PER_PIXEL 4 // more than this and the graph uses a coarser tier
+
+// per-process history: last samples of every (GPU, pid), forgotten some time after the process is gone
+#define NVSM_PROCESS_HISTORY_POINTS 60
+#define NVSM_PROCESS_HISTORY_EXPIRY 30000 // ms
+#define NVSM_PROCESS_HISTORY_MAX 4096 // processes, the least recently seen are dropped first
+#define NVSM_SPARKLINE_WIDTH 120 // px
+
+// host side process info
+#define NVSM_PROCFS_ROOT "/proc"
+#define NVSM_PROCFS_NA (-1)
+#define NVSM_PROCFS_STAT_UTIME 14 // fields of /proc/<pid>/stat, 1-based as in proc(5)
+#define NVSM_PROCFS_STAT_STIME 15
+#define NVSM_PROCFS_STAT_STARTTIME 22
+#define NVSM_PROCFS_STAT_RSS 24 // pages
+#define NVSM_CONTAINER_ID_LENGTH 64 // hex digits in docker, containerd, cri-o and podman cgroup names
+#define NVSM_CONTAINER_ID_SHORT 12
+
+// alerts
+#define NVSM_NOTIFY_COMMAND "notify-send"
+#define NVSM_NOTIFY_APP_NAME "--app-name=qnvsm"
+#define NVSM_SHELL "/bin/sh"
+// the environment of an exec command, its {rule} {gpu} {name} {value} {state} expand to these
+#define NVSM_ENV_ALERT_RULE "NVSM_ALERT_RULE"
+#define NVSM_ENV_GPU_INDEX "NVSM_GPU_INDEX"
+#define NVSM_ENV_GPU_NAME "NVSM_GPU_NAME"
+#define NVSM_ENV_ALERT_VALUE "NVSM_ALERT_VALUE"
+#define NVSM_ENV_ALERT_STATE "NVSM_ALERT_STATE"
+
+// fleet
+#define NVSM_FLEET_COMMAND_DEFAULT "ssh -o BatchMode=yes {host} " NVSMI_CMD_GPU_QUERY
+#define NVSM_FLEET_CELL_WIDTH 240 // px
+#define NVSM_FLEET_CELL_PADDING 4
+
+// accounting
+#define NVSM_GROUP_MODES 3 // user, cgroup, container
+#define NVSM_GROUP_NAME      0
+#define NVSM_GROUP_PROCESSES 1
+#define NVSM_GROUP_SM        2
+#define NVSM_GROUP_MEM       3
+#define NVSM_GROUP_SECONDS   4
+#define NVSM_GROUP_COLUMNS   5
+#define NVSM_ACCOUNTING_GROUPS_MAX 1024 // per mode
+#define NVSM_ACCOUNTING_MAX_GAP 60000 // ms, longer gaps between samples (suspend, stalls) are not counted
+
+#define NVSM_STREAM_RESTART_DELAY 1000 // ms between restarts of a dead streaming nvidia-smi
+#define NVSM_STREAM_TIMEOUT_INTERVALS 5 // a streaming nvidia-smi silent for this many intervals is restarted
+
+// child processes
+#define NVSM_EXEC_TIMEOUT 10000 // ms
+#define NVSM_EXEC_KILL_GRACE 100 // ms
+#define NVSM_EXEC_OUTPUT_MAX (16 << 20) // bytes kept of stdout and of stderr, the rest is read and dropped
+#define NVSM_STALE_INTERVALS 3 // no new sample for this many intervals marks the data stale
+#define NVSM_NVML_PROCESSES 64 // initial per-GPU process buffer size
+
+// collector socket
+#define NVSM_SERVER_BACKLOG 16
+#define NVSM_SERVER_POLL_TIMEOUT 250 // ms
+#define NVSM_CLIENT_TIMEOUT 2000 // ms
+#define NVSM_CONNECT_ATTEMPTS 10
+#define NVSM_CONNECT_RETRY_DELAY 500 // ms
+#define NVSM_SOCKET_NAME "qnvsm.sock"
+
+#define NVSM_RECORD_MAGIC "QNVSMREC"
+#define NVSM_RECORD_VERSION 1
+#define NVSM_RECORD_BLOCK_MAGIC 0x4b4c424e // "NBLK"
+#define NVSM_RECORD_BLOCK_SIZE 4096
+#define NVSM_RECORD_FLUSH_INTERVAL 10000 // ms
+#define NVSM_REPLAY_TICK 50 // ms
+
+#define NVSM_METRICS_PATH "/metrics"
+#define NVSM_MIB (1024LL * 1024LL)
+
+#define NVSM_PROTO_GPUS "gpus"
+#define NVSM_PROTO_PROCESSES "processes"
+#define NVSM_PROTO_HISTORY "history"
+#define NVSM_PROTO_HISTORY_GPU "gpu"
+#define NVSM_PROTO_HISTORY_MEMORY "memory"
+#define NVSM_PROTO_GPU "gpu"
+#define NVSM_PROTO_PROCESS "process"
+#define NVSM_PROTO_SAMPLE "sample" // time of the process sample, repeats while the collector has no newer one
+#define NVSM_PROTO_POINT "point"
+#define NVSM_PROTO_ERROR "error"
+#define NVSM_PROTO_END "end"
 
 typedef unsigned int uint;
 
@@ -0,0 +1,160 @@
+#include "fleet.h"
+#include <QPainter>
+#include <QApplication>
+
+#include "settings.h"
+#include "utilization.h"
+
+Fleet::Fleet(const std::vector<std::string> &hosts) {
+	workerThread = new WorkerThread(nullptr);
+
+	auto initial = std::make_shared<std::vector<HostSample>>(hosts.size());
+	for (size_t i = 0; i < hosts.size(); i++) {
+		(*initial)[i].host = hosts[i];
+		(*initial)[i].error = "not polled yet";
+
+		std::string host = hosts[i];
+		workerThread->addTask(FLEET_DELAY, [this, i, host]() { poll(i, host); });
+	}
+	data.store(std::move(initial));
+}
+
+Fleet::~Fleet() {
+	stop();
+	delete workerThread;
+}
+
+void Fleet::start() {
+	workerThread->start();
+}
+
+void Fleet::stop() {
+	workerThread->stop();
+	workerThread->wait();
+}
+
+void Fleet::refresh() {
+	workerThread->refresh();
+}
+
+void Fleet::setVisible(const bool visible) {
+	for (size_t i = 0; i < data.load()->size(); i++)
+		workerThread->setInterval(i, visible ? FLEET_DELAY : BACKGROUND_INTERVAL(FLEET_DELAY));
+}
+
+TaskStatistics Fleet::getStatistics() const {
+	TaskStatistics result {0, 0};
+	for (size_t i = 0; i < data.load()->size(); i++) {
+		TaskStatistics host = workerThread->getStatistics(i);
+		result.runs += host.runs;
+		result.skipped += host.skipped;
+	}
+
+	return result;
+}
+
+void Fleet::poll(const size_t index, const std::string &host) {
+	HostSample sample = pollHost(FLEET_COMMAND, host, FLEET_TIMEOUT);
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		auto next = std::make_shared<std::vector<HostSample>>(*data.load());
+		HostSample &current = (*next)[index];
+
+		// a failed poll keeps the last GPUs, they are drawn as stale
+		if (!sample.ok) {
+			sample.gpus.swap(current.gpus);
+			sample.time = current.time;
+		}
+		current = std::move(sample);
+
+		data.store(std::move(next));
+	}
+
+	dataUpdated();
+}
+
+FleetView::FleetView(Fleet *fleet, QWidget *parent) : QWidget(parent) {
+	this->fleet = fleet;
+}
+
+// every cell has room for as many GPUs as the host with the most of them
+static int cellHeight(const std::vector<HostSample> &hosts, int lineHeight) {
+	size_t gpus = 1;
+	for (const HostSample &host : hosts)
+		gpus = std::max(gpus, host.gpus.size());
+
+	return (gpus + 1) * lineHeight + 2 * NVSM_FLEET_CELL_PADDING;
+}
+
+void FleetView::paintEvent(QPaintEvent *) {
+	std::shared_ptr<const std::vector<HostSample>> hosts = fleet->data.load();
+
+	QPainter p(this);
+	QFontMetrics fontMetrics(font());
+	int lineHeight = fontMetrics.height() + 2;
+	int height = cellHeight(*hosts, lineHeight);
+	int barWidth = (NVSM_FLEET_CELL_WIDTH - 4 * NVSM_FLEET_CELL_PADDING - fontMetrics.horizontalAdvance("00")) / 2;
+	QColor text = QApplication::palette().text().color();
+
+	for (size_t i = 0; i < hosts->size(); i++) {
+		const HostSample &host = (*hosts)[i];
+		int x = (i % columns) * NVSM_FLEET_CELL_WIDTH, y = (i / columns) * height;
+		int textX = x + NVSM_FLEET_CELL_PADDING, textY = y + NVSM_FLEET_CELL_PADDING + fontMetrics.ascent();
+
+		p.setPen(QColor(100, 100, 100));
+		p.setBrush(Qt::NoBrush);
+		p.drawRect(x + 1, y + 1, NVSM_FLEET_CELL_WIDTH - 2, height - 2);
+
+		p.setPen(text);
+		p.drawText(textX, textY, host.host.c_str());
+		if (!host.ok) {
+			p.setPen(QColor(220, 0, 0));
+			p.drawText(textX + fontMetrics.horizontalAdvance((host.host + " ").c_str()), textY, host.error.c_str());
+		}
+
+		// stale values stay visible, faded
+		for (size_t GPU = 0; GPU < host.gpus.size(); GPU++) {
+			const GPUSample &gpu = host.gpus[GPU];
+			int memory = gpu.memoryTotal > 0 ? gpu.memoryUsed * 100 / gpu.memoryTotal : 0;
+			int lineY = y + NVSM_FLEET_CELL_PADDING + (GPU + 1) * lineHeight;
+			QColor color = gpuColors[GPU % 8];
+			color.setAlpha(host.ok ? 160 : 48);
+
+			p.setPen(text);
+			p.drawText(textX, lineY + fontMetrics.ascent(), QString::number((int) GPU));
+
+			int barX = textX + fontMetrics.horizontalAdvance("00") + NVSM_FLEET_CELL_PADDING;
+			for (int value : {gpu.utilization, memory}) {
+				p.setPen(Qt::NoPen);
+				p.setBrush(color);
+				p.drawRect(barX, lineY, barWidth * value / 100, lineHeight - 2);
+				p.setPen(QColor(100, 100, 100));
+				p.setBrush(Qt::NoBrush);
+				p.drawRect(barX, lineY, barWidth, lineHeight - 2);
+				p.setPen(text);
+				p.drawText(barX + 2, lineY + fontMetrics.ascent(), (std::to_string(value) + " %").c_str());
+
+				barX += barWidth + NVSM_FLEET_CELL_PADDING;
+			}
+		}
+	}
+}
+
+void FleetView::resizeEvent(QResizeEvent *) {
+	columns = std::max(1, width() / NVSM_FLEET_CELL_WIDTH);
+	updateHeight();
+}
+
+void FleetView::onDataUpdated() {
+	updateHeight();
+	update();
+}
+
+// the scroll area around the view scrolls once the cells need more height than it has
+void FleetView::updateHeight() {
+	std::shared_ptr<const std::vector<HostSample>> hosts = fleet->data.load();
+	int rows = (hosts->size() + columns - 1) / columns;
+
+	setMinimumHeight(rows * cellHeight(*hosts, QFontMetrics(font()).height() + 2));
+}
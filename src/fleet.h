@@ -0,0 +1,68 @@
+#ifndef FLEET_H
+#define FLEET_H
+
+#include <QWidget>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "hostpoll.h"
+#include "snapshot.h"
+#include "worker.h"
+
+/**
+ * Polls many hosts with FLEET_COMMAND, {host} replaced. Every host is a task
+ * of its own on a WorkerThread, so a slow or dead host only skips its own
+ * polls, and each poll is killed after FLEET_TIMEOUT
+ */
+class Fleet : public QObject {
+	Q_OBJECT
+public:
+	Snapshot<std::vector<HostSample>> data; // in the order of the hosts
+
+	explicit Fleet(const std::vector<std::string> &hosts);
+	~Fleet() override;
+
+	void start();
+	void stop(); // blocks until all polls are done
+	void refresh(); // polls all hosts now
+
+	// hidden, the hosts are polled every BACKGROUND_INTERVAL, and all at once when shown again
+	void setVisible(bool visible);
+
+	TaskStatistics getStatistics() const; // of all hosts
+
+signals:
+	void dataUpdated();
+
+private:
+	WorkerThread *workerThread;
+	std::mutex mutex; // polls of different hosts finish at the same time, only one publishes at once
+
+	void poll(size_t index, const std::string &host);
+};
+
+/**
+ * A compact cell per host: utilization and memory bars of its GPUs, or why
+ * the host could not be polled
+ */
+class FleetView : public QWidget {
+	Q_OBJECT
+public:
+	Fleet *fleet;
+
+	explicit FleetView(Fleet *fleet, QWidget *parent = nullptr);
+
+	void paintEvent(QPaintEvent *event) override;
+	void resizeEvent(QResizeEvent *event) override;
+
+public slots:
+	void onDataUpdated();
+
+private:
+	int columns = 1;
+
+	void updateHeight();
+};
+
+#endif
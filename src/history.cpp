@@ -0,0 +1,30 @@
+#include "history.h"
+
+void HistoryTier::setup(const long resolution, const size_t capacity) {
+    this->resolution = resolution;
+    buckets.setCapacity(capacity);
+}
+
+void HistoryTier::add(const long time, const int value) {
+    long start = time - time % resolution;
+
+    if (!buckets.empty() && buckets.back().time == start) {
+        Bucket &bucket = buckets.back();
+        bucket.min = value < bucket.min ? value : bucket.min;
+        bucket.max = value > bucket.max ? value : bucket.max;
+        bucket.sum += value;
+        bucket.count++;
+        return;
+    }
+
+    buckets.push_back({start, value, value, value, 1});
+}
+
+void HistoryTier::clear() {
+    buckets.clear();
+}
+
+bool HistoryTier::covers(const long length) const {
+    // a partial bucket at each end
+    return static_cast<size_t>(length / resolution) + 2 <= buckets.capacity();
+}
@@ -0,0 +1,36 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include "ringbuffer.h"
+
+struct Bucket {
+    long time; // start of the bucket, ms
+    int min, max;
+    long sum;
+    int count;
+
+    int average() const { return count > 0 ? static_cast<int>(sum / count) : 0; }
+};
+
+/**
+ * A series rolled up into min / avg / max buckets of a fixed width. The
+ * oldest buckets are overwritten, so memory is bounded by the capacity
+ * however long the app runs
+ */
+class HistoryTier {
+public:
+    long resolution = 1; // bucket width, ms
+    RingBuffer<Bucket> buckets;
+
+    void setup(long resolution, size_t capacity);
+
+    // time must not go back
+    void add(long time, int value);
+
+    void clear();
+
+    // whether the buckets are enough for a window of length ms
+    bool covers(long length) const;
+};
+
+#endif
@@ -0,0 +1,34 @@
+#include "hostpoll.h"
+
+#include "parser.h"
+#include "utils.h"
+
+HostSample pollHost(const std::string &command, const std::string &host, const int timeout) {
+    std::string cmd = command;
+    for (size_t pos = 0; (pos = cmd.find("{host}", pos)) != std::string::npos; pos += host.size())
+        cmd.replace(pos, 6, host);
+
+    HostSample sample;
+    sample.host = host;
+
+    ExecResult result = run(cmd, timeout);
+
+    if (result.timedOut) {
+        sample.error = "timed out after " + std::to_string(timeout) + " ms";
+    } else if (!result.ok()) {
+        sample.error = result.status == -1 ? "could not be started" : "exit code " + std::to_string(result.status);
+        if (!result.err.empty())
+            sample.error += ": " + result.err.substr(0, result.err.find('\n'));
+    } else {
+        forEachLine(result.out, [&sample](std::string_view line) { parseGPUQueryLine(line, sample.gpus); });
+
+        if (sample.gpus.empty())
+            sample.error = "no GPUs in the output";
+        else {
+            sample.ok = true;
+            sample.time = getTime();
+        }
+    }
+
+    return sample;
+}
@@ -0,0 +1,20 @@
+#ifndef HOSTPOLL_H
+#define HOSTPOLL_H
+
+#include <string>
+#include <vector>
+
+#include "source.h"
+
+struct HostSample {
+    std::string host;
+    std::vector<GPUSample> gpus; // of the last successful poll
+    bool ok = false; // the last poll succeeded
+    std::string error; // why it did not
+    long time = 0; // of the last successful poll, ms
+};
+
+// runs command with {host} replaced and parses its nvidia-smi query csv; a failed poll has no GPUs
+HostSample pollHost(const std::string &command, const std::string &host, int timeout);
+
+#endif
@@ -3,16 +3,35 @@
 #include "mainwindow.h"
 #include "settings.h"
 #include "utils.h"
+#include "nvml.h"
+#include "nvidiasmi.h"
+#include "socketsource.h"
+#include "server.h"
+#include "replay.h"
 
 #include <iostream>
 #include <fstream>
+#include <csignal>
 #include <unistd.h>
 #include <pwd.h>
 
 // set to default
 uint UPDATE_DELAY = 2000; // 2 sec
 uint GRAPH_LENGTH = 60000; // 60 sec
+uint PROCESSES_DELAY = 0;
 int GPU_COUNT = -1;
+bool STREAMING = true;
+std::string METRICS_SOURCE = NVSM_SOURCE_AUTO;
+std::string NVML_LIBRARY = NVML_LIBRARY_DEFAULT;
+uint METRICS_PORT = 0;
+std::string RECORD_PATH;
+std::string PROC_ROOT = NVSM_PROCFS_ROOT;
+std::vector<std::string> ALERT_RULES;
+std::vector<std::string> FLEET_HOSTS;
+std::string FLEET_COMMAND = NVSM_FLEET_COMMAND_DEFAULT;
+uint FLEET_DELAY = 5000;
+uint FLEET_TIMEOUT = 4000;
+uint BACKGROUND_DELAY = 10000;
 
 QColor gpuColors[8] = {
     _c(0, 255, 0),
@@ -25,25 +44,33 @@ QColor gpuColors[8] = {
     _c(32, 32, 32)
 };
 
-void init() {
-    std::cout << "Connecting to nvidia-smi...\n";
-    if (system("which nvidia-smi > /dev/null 2>&1")) {
-        std::cout << "nvidia-smi not found. Are you have NVIDIA drivers?\n";
-        QMessageBox::critical(nullptr, "Critical", "nvidia-smi not found. Are you have NVIDIA drivers?");
-        exit(EXIT_FAILURE);
-    } else {
-        std::string nvsmi_out = exec("nvidia-smi");
-        if (startsWith(split(nvsmi_out, "\n"), "NVIDIA-SMI has failed") != std::string::npos) {
-            std::cout << "nvidia-smi was found, but " << nvsmi_out;
-            QMessageBox::critical(nullptr, "Critical", (nvsmi_out + "If you using laptop with discrete NVIDIA GPU, launch this app with optirun").c_str());
-            exit(EXIT_FAILURE);
-        }
-    }
+// command line options
+static bool headless = false;
+static std::string socketPath;  // where a headless collector listens
+static std::string connectPath; // collector to read from instead of the GPUs
+static int metricsPort = -1;    // overrides the config value
+static std::string recordPath;  // overrides the config value
+static std::string replayPath;  // recording to play instead of collecting
+static ReplaySource *replaySource = nullptr;
 
-    std::cout << "Loading settings\n";
+// reports an error that prevents the app from starting
+static void fatal(const std::string &message) {
+    std::cout << message << "\n";
+    if (!headless)
+        QMessageBox::critical(nullptr, "Critical", message.c_str());
+    exit(EXIT_FAILURE);
+}
 
-    GPU_COUNT = atoi(split(exec(NVSMI_CMD_GPU_COUNT), "\n")[1].c_str());
-    std::cout << "GPU Count is " << GPU_COUNT << "\n";
+static std::string defaultSocketPath() {
+    const char *runtimeDir = getenv("XDG_RUNTIME_DIR");
+    if (runtimeDir)
+        return std::string(runtimeDir) + "/" NVSM_SOCKET_NAME;
+
+    return "/tmp/qnvsm-" + std::to_string(getuid()) + ".sock";
+}
+
+void loadSettings() {
+    std::cout << "Loading settings\n";
 
     std::string path = getpwuid(getuid())->pw_dir;
     path += "/.config/nvidia-system-monitor/config";
@@ -67,6 +94,69 @@ void init() {
         GRAPH_LENGTH = atoi(split(streamline(lines[lineIndex]), " ")[1].c_str());
         lines.erase(lines.begin() + lineIndex);
     }
+    if ((lineIndex = startsWith(lines, NVSM_CONF_PROCESSES_DELAY)) != std::string::npos) {
+        PROCESSES_DELAY = atoi(split(streamline(lines[lineIndex]), " ")[1].c_str());
+        lines.erase(lines.begin() + lineIndex);
+    }
+    if ((lineIndex = startsWith(lines, NVSM_CONF_STREAMING)) != std::string::npos) {
+        STREAMING = atoi(split(streamline(lines[lineIndex]), " ")[1].c_str()) != 0;
+        lines.erase(lines.begin() + lineIndex);
+    }
+    if ((lineIndex = startsWith(lines, NVSM_CONF_SOURCE)) != std::string::npos) {
+        METRICS_SOURCE = split(streamline(lines[lineIndex]), " ")[1];
+        METRICS_SOURCE.pop_back(); // streamline() terminates the line with '\n'
+        lines.erase(lines.begin() + lineIndex);
+    }
+    if ((lineIndex = startsWith(lines, NVSM_CONF_NVML_LIBRARY)) != std::string::npos) {
+        NVML_LIBRARY = split(streamline(lines[lineIndex]), " ")[1];
+        NVML_LIBRARY.pop_back();
+        lines.erase(lines.begin() + lineIndex);
+    }
+    if ((lineIndex = startsWith(lines, NVSM_CONF_METRICS_PORT)) != std::string::npos) {
+        METRICS_PORT = atoi(split(streamline(lines[lineIndex]), " ")[1].c_str());
+        lines.erase(lines.begin() + lineIndex);
+    }
+    if ((lineIndex = startsWith(lines, NVSM_CONF_RECORD)) != std::string::npos) {
+        RECORD_PATH = split(streamline(lines[lineIndex]), " ")[1];
+        RECORD_PATH.pop_back();
+        lines.erase(lines.begin() + lineIndex);
+    }
+    if ((lineIndex = startsWith(lines, NVSM_CONF_PROC_ROOT)) != std::string::npos) {
+        PROC_ROOT = split(streamline(lines[lineIndex]), " ")[1];
+        PROC_ROOT.pop_back();
+        lines.erase(lines.begin() + lineIndex);
+    }
+    if ((lineIndex = startsWith(lines, NVSM_CONF_BACKGROUND_DELAY)) != std::string::npos) {
+        BACKGROUND_DELAY = atoi(split(streamline(lines[lineIndex]), " ")[1].c_str());
+        lines.erase(lines.begin() + lineIndex);
+    }
+
+    if ((lineIndex = startsWith(lines, NVSM_CONF_FLEET_COMMAND)) != std::string::npos) {
+        // the command takes the rest of the line
+        std::string line = streamline(lines[lineIndex]);
+        FLEET_COMMAND = line.substr(line.find(' ') + 1);
+        FLEET_COMMAND.pop_back();
+        lines.erase(lines.begin() + lineIndex);
+    }
+    if ((lineIndex = startsWith(lines, NVSM_CONF_FLEET_DELAY)) != std::string::npos) {
+        FLEET_DELAY = atoi(split(streamline(lines[lineIndex]), " ")[1].c_str());
+        lines.erase(lines.begin() + lineIndex);
+    }
+    if ((lineIndex = startsWith(lines, NVSM_CONF_FLEET_TIMEOUT)) != std::string::npos) {
+        FLEET_TIMEOUT = atoi(split(streamline(lines[lineIndex]), " ")[1].c_str());
+        lines.erase(lines.begin() + lineIndex);
+    }
+    while ((lineIndex = startsWith(lines, NVSM_CONF_FLEET_HOST)) != std::string::npos) {
+        std::string host = split(streamline(lines[lineIndex]), " ")[1];
+        host.pop_back();
+        FLEET_HOSTS.push_back(host);
+        lines.erase(lines.begin() + lineIndex);
+    }
+
+    while ((lineIndex = startsWith(lines, NVSM_CONF_ALERT)) != std::string::npos) {
+        ALERT_RULES.push_back(lines[lineIndex]);
+        lines.erase(lines.begin() + lineIndex);
+    }
 
     lineIndex = 0;
     while (lineIndex != std::string::npos) {
@@ -80,15 +170,175 @@ void init() {
     std::cout << "Done\n";
 }
 
+MetricsSource* init() {
+    loadSettings();
+
+    if (metricsPort >= 0)
+        METRICS_PORT = metricsPort;
+    if (!recordPath.empty())
+        RECORD_PATH = recordPath;
+
+    if (!replayPath.empty()) {
+        std::cout << "Replaying " << replayPath << "\n";
+        replaySource = new ReplaySource;
+        if (!replaySource->recording.open(replayPath))
+            fatal("Could not replay " + replayPath);
+
+        // the graph buffers are sized for the recorded interval
+        GPU_COUNT = replaySource->recording.getGPUCount();
+        UPDATE_DELAY = replaySource->recording.getInterval();
+        RECORD_PATH.clear();
+
+        std::cout << "GPU Count is " << GPU_COUNT << "\n";
+        return replaySource;
+    }
+
+    if (!connectPath.empty()) {
+        std::cout << "Connecting to collector at " << connectPath << "...\n";
+        auto *collector = new SocketSource(connectPath);
+
+        // a collector that has just started may not have sampled the GPUs yet
+        std::vector<GPUSample> gpus;
+        for (int attempt = 0; attempt < NVSM_CONNECT_ATTEMPTS && gpus.empty(); attempt++) {
+            if (!collector->sampleGPUs(gpus))
+                fatal("Could not connect to collector at " + connectPath);
+            if (gpus.empty())
+                usleep(NVSM_CONNECT_RETRY_DELAY * 1000);
+        }
+
+        GPU_COUNT = gpus.size();
+        std::cout << "GPU Count is " << GPU_COUNT << "\n";
+        return collector;
+    }
+
+    if (METRICS_SOURCE != NVSM_SOURCE_NVIDIA_SMI) {
+        std::cout << "Connecting to NVML...\n";
+        auto *nvml = new NVMLSource(NVML_LIBRARY, PROC_ROOT);
+        if (nvml->isAvailable()) {
+            GPU_COUNT = nvml->getGPUCount();
+            std::cout << "GPU Count is " << GPU_COUNT << "\n";
+            return nvml;
+        }
+
+        delete nvml;
+        std::cout << "NVML is not available, falling back to nvidia-smi\n";
+    }
+
+    std::cout << "Connecting to nvidia-smi...\n";
+    if (system("which nvidia-smi > /dev/null 2>&1")) {
+        fatal("nvidia-smi not found. Are you have NVIDIA drivers?");
+    } else {
+        ExecResult nvsmi = run("nvidia-smi");
+        if (nvsmi.timedOut)
+            fatal("nvidia-smi does not respond");
+        if (startsWith(split(nvsmi.out, "\n"), "NVIDIA-SMI has failed") != std::string::npos)
+            fatal(nvsmi.out + "If you using laptop with discrete NVIDIA GPU, launch this app with optirun");
+    }
+
+    std::vector<std::string> count = split(exec(NVSMI_CMD_GPU_COUNT), "\n");
+    if (count.size() < 2)
+        fatal("Could not get the GPU count from nvidia-smi");
+    GPU_COUNT = atoi(count[1].c_str());
+    std::cout << "GPU Count is " << GPU_COUNT << "\n";
+
+    return new NvidiaSmiSource;
+}
+
+// collects without any window and serves the data on socketPath until SIGINT / SIGTERM
+// serves /metrics on METRICS_PORT if it is set, nullptr otherwise
+static MetricsServer* startMetrics(Collector *collector) {
+    if (METRICS_PORT == 0)
+        return nullptr;
+
+    auto *metrics = new MetricsServer(collector);
+    if (!metrics->listen(METRICS_PORT)) {
+        delete metrics;
+        return nullptr;
+    }
+
+    metrics->start();
+    collector->exported = true;
+
+    return metrics;
+}
+
+int runHeadless(int argc, char** argv) {
+    // blocked before any thread starts, so every thread inherits the mask and sigwait() gets them
+    sigset_t stopSignals;
+    sigemptyset(&stopSignals);
+    sigaddset(&stopSignals, SIGINT);
+    sigaddset(&stopSignals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stopSignals, nullptr);
+
+    QCoreApplication app(argc, argv);
+
+    Collector collector(init());
+    SnapshotServer server(&collector, socketPath);
+    if (!server.listen())
+        return EXIT_FAILURE;
+
+    collector.start();
+    server.start();
+    MetricsServer *metrics = startMetrics(&collector);
+
+    int received;
+    sigwait(&stopSignals, &received);
+
+    std::cout << "Stopping collector\n";
+    delete metrics;
+    server.stop();
+    collector.stop();
+
+    return EXIT_SUCCESS;
+}
+
 int main(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--headless")
+            headless = true;
+        else if (arg == "--socket" && i + 1 < argc)
+            socketPath = argv[++i];
+        else if (arg == "--connect")
+            connectPath = i + 1 < argc && argv[i + 1][0] != '-' ? argv[++i] : defaultSocketPath();
+        else if (arg == "--metrics-port" && i + 1 < argc)
+            metricsPort = atoi(argv[++i]);
+        else if (arg == "--record" && i + 1 < argc)
+            recordPath = argv[++i];
+        else if (arg == "--replay" && i + 1 < argc)
+            replayPath = argv[++i];
+    }
+
+    if (socketPath.empty())
+        socketPath = defaultSocketPath();
+
+    if (headless && !replayPath.empty()) {
+        std::cout << "A recording can only be replayed in the window\n";
+        return EXIT_FAILURE;
+    }
+
+    if (headless)
+        return runHeadless(argc, argv);
+
     QApplication app(argc, argv);
 
-    init();
+    MetricsSource *source = init();
 
-    MainWindow w;
+    MainWindow w(source);
+    MetricsServer *metrics = startMetrics(w.collector); // before show(), served samples are not slowed down
     w.resize(512, 512);
     w.setWindowTitle("NVIDIA System Monitor");
     w.show();
 
-    return QApplication::exec();
+    Replay *replay = nullptr;
+    if (replaySource) {
+        replay = new Replay(&replaySource->recording, w.collector->gpuUtilization, w.collector->memoryUtilization);
+        w.addReplayControls(replay);
+    }
+
+    int status = QApplication::exec();
+    delete metrics; // before the window deletes the collector
+    delete replay;
+
+    return status;
 }
@@ -6,19 +6,33 @@
 #include <QVBoxLayout>
 #include <QMessageBox>
 #include <QCloseEvent>
+#include <QHBoxLayout>
+#include <QSlider>
+#include <QLabel>
+#include <QComboBox>
+#include <QDateTime>
+#include <QScrollArea>
+#include <sys/resource.h>
 
 #include "processes.h"
+#include "accountingview.h"
 #include "utilization.h"
+#include "settings.h"
+#include "utils.h"
 
-MainWindow::MainWindow(QWidget*)
+MainWindow::MainWindow(MetricsSource *source, QWidget*)
 {
 	auto* layout = new QVBoxLayout;
 	layout->setSpacing(0);
 	layout->setMargin(0);
 
 	auto* menuBar = new QMenuBar;
+	auto* view = new QMenu("&View");
 	auto* menu = new QMenu("&Help");
 
+	view->addAction("&Refresh now", this, SLOT(refresh()), Qt::Key_F5);
+	view->addAction("Sampling &statistics", this, SLOT(statistics()));
+
 	menu->addAction("&About NVSM", this, SLOT(about()), Qt::CTRL + Qt::Key_A);
 	menu->addAction("&Help", this, SLOT(help()), Qt::CTRL + Qt::Key_H);
 	menu->addSeparator();
@@ -26,23 +40,45 @@ MainWindow::MainWindow(QWidget*)
 	menu->addSeparator();
 	menu->addAction("&Exit", qApp, SLOT(quit()));
 
+	menuBar->addMenu(view);
 	menuBar->addMenu(menu);
 	layout->addWidget(menuBar);
 
-	auto* processes = new ProcessesTableView;
+	collector = new Collector(source);
+
+	auto* processes = new ProcessesTableView(collector->processes);
+	auto* accounting = new AccountingView(collector->processes);
 
 	auto* gwidget = new QWidget();
 	auto* glayout = new QVBoxLayout;
-	auto* gutilization = new GPUUtilization;
+	auto* gutilization = new GPUUtilization(collector->gpuUtilization);
 	glayout->addWidget(gutilization);
 	glayout->setMargin(32);
 	gwidget->setLayout(glayout);
-	auto* mutilization = new MemoryUtilization;
+	auto* mutilization = new MemoryUtilization(collector->memoryUtilization);
 	glayout->addWidget(mutilization);
 
+	processesTab = processes;
+	accountingTab = accounting;
+	graphsTab = gwidget;
+
 	tabs = new QTabWidget();
 	tabs->addTab(processes, "Processes");
+	tabs->addTab(accounting, "Accounting");
 	tabs->addTab(gwidget, "GPU Utilization");
+
+	if (!FLEET_HOSTS.empty())
+	{
+		fleet = new Fleet(FLEET_HOSTS);
+		auto* fleetView = new FleetView(fleet);
+		auto* scroll = new QScrollArea;
+		scroll->setWidget(fleetView);
+		scroll->setWidgetResizable(true);
+		tabs->addTab(scroll, "Fleet");
+		fleetTab = scroll;
+		connect(fleet, &Fleet::dataUpdated, fleetView, &FleetView::onDataUpdated);
+		fleet->start();
+	}
 	layout->addWidget(tabs);
 
 	auto* window = new QWidget();
@@ -50,25 +86,133 @@ MainWindow::MainWindow(QWidget*)
 	setCentralWidget(window);
 
 	connect(processes->worker, &ProcessesWorker::dataUpdated, processes, &ProcessesTableView::onDataUpdated);
+	connect(accounting->worker, &ProcessesWorker::dataUpdated, accounting, &AccountingView::onDataUpdated);
 	connect(gutilization->worker, &GPUUtilizationWorker::dataUpdated, gutilization, &GPUUtilization::onDataUpdated);
 	connect(mutilization->worker, &MemoryUtilizationWorker::dataUpdated, mutilization, &MemoryUtilization::onDataUpdated);
+	connect(tabs, &QTabWidget::currentChanged, this, [this](int) { updateSampling(); });
+
+	collector->start();
+
+}
+
+MainWindow::~MainWindow()
+{
+	delete fleet;
+	delete collector;
+}
+
+void MainWindow::addReplayControls(Replay* replay)
+{
+	auto* controls = new QWidget();
+	auto* layout = new QHBoxLayout;
+	auto* pause = new QPushButton("Pause");
+	auto* position = new QSlider(Qt::Horizontal);
+	auto* time = new QLabel;
+	auto* speed = new QComboBox;
 
-	workerThread = new WorkerThread;
-	workerThread->workers[0] = processes->worker;
-	workerThread->workers[1] = gutilization->worker;
-	workerThread->workers[2] = mutilization->worker;
-	workerThread->start();
+	pause->setCheckable(true);
+	position->setRange(0, (replay->getEnd() - replay->getBegin()) / 1000);
+	for (int factor : {1, 2, 10, 60, 600, 3600})
+		speed->addItem(QString::number(factor) + "x", factor);
 
+	layout->addWidget(pause);
+	layout->addWidget(position);
+	layout->addWidget(time);
+	layout->addWidget(speed);
+	controls->setLayout(layout);
+	centralWidget()->layout()->addWidget(controls);
+
+	connect(pause, &QPushButton::toggled, replay, &Replay::setPaused);
+	connect(replay, &Replay::pausedChanged, pause, &QPushButton::setChecked);
+	connect(position, &QSlider::sliderMoved, this, [=](int seconds) {
+		replay->seek(replay->getBegin() + seconds * 1000L);
+	});
+	connect(speed, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [=](int index) {
+		replay->setSpeed(speed->itemData(index).toDouble());
+	});
+	connect(replay, &Replay::positionChanged, this, [=](long current) {
+		if (!position->isSliderDown())
+			position->setValue((current - replay->getBegin()) / 1000);
+		time->setText(QDateTime::fromMSecsSinceEpoch(current).toString("yyyy-MM-dd hh:mm:ss"));
+	});
 }
 
 void MainWindow::closeEvent(QCloseEvent* event)
 {
 	hide();
-	workerThread->running = false;
-	while (workerThread->isRunning()); // waiting for all workers to be safely removed
+	collector->stop();
+	if (fleet)
+		fleet->stop();
 	event->accept();
 }
 
+void MainWindow::changeEvent(QEvent* event)
+{
+	QMainWindow::changeEvent(event);
+	if (event->type() == QEvent::WindowStateChange)
+		updateSampling();
+}
+
+void MainWindow::showEvent(QShowEvent* event)
+{
+	QMainWindow::showEvent(event);
+	shown = true;
+	updateSampling();
+}
+
+void MainWindow::hideEvent(QHideEvent* event)
+{
+	QMainWindow::hideEvent(event);
+	shown = false;
+	updateSampling();
+}
+
+// a minimized or hidden window shows nothing, otherwise only the current tab can be seen
+void MainWindow::updateSampling()
+{
+	bool visible = shown && !isMinimized();
+	QWidget* current = tabs->currentWidget();
+
+	collector->setVisible(visible && current == graphsTab,
+		visible && (current == processesTab || current == accountingTab));
+	if (fleet)
+		fleet->setVisible(visible && current == fleetTab);
+}
+
+void MainWindow::refresh()
+{
+	collector->refresh();
+	if (fleet)
+		fleet->refresh();
+}
+
+void MainWindow::statistics()
+{
+	auto line = [](const char* name, const TaskStatistics& task) {
+		return QString("%1: %2 samples, %3 skipped while hidden<br>").arg(name).arg(task.runs).arg(task.skipped);
+	};
+
+	QString text;
+	text += line("GPUs", collector->workerThread->getStatistics(collector->gpuTask));
+	text += line("Processes", collector->workerThread->getStatistics(collector->processesTask));
+	if (fleet)
+		text += line("Fleet", fleet->getStatistics());
+
+	// every skipped nvidia-smi sample is a child process that was not started
+	rusage self {}, children {};
+	getrusage(RUSAGE_SELF, &self);
+	getrusage(RUSAGE_CHILDREN, &children);
+	auto seconds = [](const rusage& usage) {
+		return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+	};
+
+	text += QString("<br>Child processes started: %1<br>").arg(getSpawnCount());
+	text += QString("CPU time: %1 s, %2 s of it in exited child processes")
+		.arg(seconds(self) + seconds(children), 0, 'f', 1).arg(seconds(children), 0, 'f', 1);
+
+	QMessageBox::information(this, "Sampling statistics", text);
+}
+
 void MainWindow::about()
 {
 	QMessageBox::information(nullptr, "About", R"(<font size=4><b>NVIDIA System Monitor</b></font>
@@ -88,7 +232,19 @@ void MainWindow::help()
 		<ul>
 			<li>updateDelay &lt;time in ms&gt;</li>
 			<li>graphLength &lt;time in ms&gt;</li>
+			<li>processesDelay &lt;time in ms&gt;</li>
+			<li>backgroundDelay &lt;time in ms, 0 pauses what can not be seen&gt;</li>
 			<li>gpuColor &lt;gpu index&gt; &lt;red&gt; &lt;green&gt; &lt;blue&gt;</li>
+			<li>streaming &lt;0 or 1&gt;</li>
+			<li>source &lt;auto, nvml or nvidia-smi&gt;</li>
+			<li>nvmlLibrary &lt;path&gt;</li>
+			<li>metricsPort &lt;port, 0 to disable&gt;</li>
+			<li>record &lt;path&gt;</li>
+			<li>procRoot &lt;path, /proc by default&gt;</li>
+			<li>fleetHost &lt;host&gt;, fleetCommand &lt;command with {host}&gt;, fleetDelay &lt;time in ms&gt;,
+				fleetTimeout &lt;time in ms&gt;</li>
+			<li>alert &lt;name&gt; &lt;metric&gt; &lt;op&gt; &lt;threshold&gt; [and ...] [for &lt;ms&gt;] [hysteresis &lt;value&gt;]
+				&lt;log, notify or exec &lt;command&gt;&gt;</li>
 		</ul><br>
 		<b>Processes</b>
 		<ul>
@@ -100,8 +256,12 @@ void MainWindow::help()
 			<li>GPU memory usage [%]</li>
 			<li>Encoding use [%]</li>
 			<li>Decoding use [%]</li>
+			<li>User, CPU [% of one core], RSS and Container - from procfs, hover the name for the command line</li>
+			<li>History - compute and GPU memory use, hover for min / avg / max</li>
 		</ul><br>
-		<b>GPU Utilization</b><br>This section displays a graph of gpu utilization.
+		<b>Accounting</b><br>Processes grouped by user, cgroup or container: process count, compute use, GPU memory use,
+		and GPU seconds (compute use over time, 100 % for one second is one GPU second) since the app started.
+		<br><br><b>GPU Utilization</b><br>This section displays a graph of gpu utilization.
 		<br><br><b>Memory Utilization</b><br>This section displays a graph of memory utilization.
 		<br><br><a href='https://github.com/congard/nvidia-system-monitor-qt/blob/master/DONATE.md'>Donate</a> <a href='https://github.com/congard/nvidia-system-monitor-qt'>GitHub</a> <a href='https://t.me/congard'>Telegram</a>)");
 	msgBox.exec();
@@ -4,20 +4,38 @@
 #include <QMainWindow>
 #include <qobjectdefs.h>
 
-#include "worker.h"
+#include "collector.h"
+#include "replay.h"
+#include "fleet.h"
 
 class MainWindow : public QMainWindow {
     Q_OBJECT
 public:
-    WorkerThread *workerThread;
+    Collector *collector;
     QTabWidget *tabs;
+    Fleet *fleet = nullptr; // if FLEET_HOSTS are configured
     
-    explicit MainWindow(QWidget *parent = nullptr);
+    explicit MainWindow(MetricsSource *source, QWidget *parent = nullptr);
+    ~MainWindow() override;
+
+    // play / pause, position and speed of a replayed recording
+    void addReplayControls(Replay *replay);
 
     void closeEvent(QCloseEvent *event) override;
+    void changeEvent(QEvent *event) override;
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
 private slots:
     static void about();
     static void help();
+    void refresh();
+    void statistics();
+private:
+    QWidget *processesTab, *accountingTab, *graphsTab, *fleetTab = nullptr;
+    bool shown = false;
+
+    // samples at full rate only what can be seen
+    void updateSampling();
 };
 
 #endif
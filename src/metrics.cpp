@@ -0,0 +1,57 @@
+#include "metrics.h"
+
+#include <sstream>
+
+#include "constants.h"
+
+// label values may contain anything, see the exposition format
+static std::string label(const std::string &value) {
+    std::string escaped;
+    for (char c : value) {
+        if (c == '\\' || c == '"')
+            escaped += '\\';
+        if (c == '\n')
+            escaped += "\\n";
+        else
+            escaped += c;
+    }
+    return escaped;
+}
+
+static void family(std::ostringstream &out, const char *name, const char *help) {
+    out << "# HELP " << name << ' ' << help << "\n# TYPE " << name << " gauge\n";
+}
+
+std::string renderMetrics(const std::vector<GPUMetrics> &gpus, const std::vector<ProcessSample> &processes) {
+    std::ostringstream out;
+
+    // values the source does not report are left out instead of exported as -1
+    #define _gpus(metric, help, field, scale) \
+        family(out, metric, help); \
+        for (size_t i = 0; i < gpus.size(); i++) \
+            if (gpus[i].field != NVSM_NA) \
+                out << metric "{gpu=\"" << i << "\",name=\"" << label(gpus[i].name) << "\"} " \
+                    << (long long) gpus[i].field * (scale) << '\n';
+
+    _gpus("nvsm_gpu_utilization_percent", "GPU utilization.", utilization, 1)
+    _gpus("nvsm_gpu_memory_used_bytes", "Used GPU memory.", memoryUsed, NVSM_MIB)
+    _gpus("nvsm_gpu_memory_free_bytes", "Free GPU memory.", memoryFree, NVSM_MIB)
+    _gpus("nvsm_gpu_memory_total_bytes", "Total GPU memory.", memoryTotal, NVSM_MIB)
+
+    #undef _gpus
+
+    #define _processes(metric, help, field, scale) \
+        family(out, metric, help); \
+        for (const ProcessSample &p : processes) \
+            if (p.pid != NVSM_NA && p.field != NVSM_NA) \
+                out << metric "{gpu=\"" << p.GPUIndex << "\",pid=\"" << p.pid << "\",name=\"" << label(p.name) \
+                    << "\",type=\"" << label(p.type) << "\"} " << (long long) p.field * (scale) << '\n';
+
+    _processes("nvsm_process_sm_utilization_percent", "SM utilization of the process.", sm, 1)
+    _processes("nvsm_process_memory_utilization_percent", "Memory controller utilization of the process.", mem, 1)
+    _processes("nvsm_process_fb_used_bytes", "Frame buffer memory used by the process.", fb, NVSM_MIB)
+
+    #undef _processes
+
+    return out.str();
+}
@@ -0,0 +1,19 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <string>
+#include <vector>
+
+#include "source.h"
+
+// what /metrics exports of a GPU, by index; NVSM_NA values are left out
+struct GPUMetrics {
+    std::string name;
+    int utilization = NVSM_NA; // %
+    int memoryUsed = NVSM_NA, memoryFree = NVSM_NA, memoryTotal = NVSM_NA; // MiB
+};
+
+// Prometheus text exposition format 0.0.4, every family is a gauge
+std::string renderMetrics(const std::vector<GPUMetrics> &gpus, const std::vector<ProcessSample> &processes);
+
+#endif
@@ -0,0 +1,45 @@
+#include "nametable.h"
+
+const std::string& NameTable::Names::get(const uint32_t id) const {
+    static const std::string none;
+
+    auto it = strings.find(id);
+    return it != strings.end() ? it->second : none;
+}
+
+uint32_t NameTable::intern(const std::string &name, const long time) {
+    auto it = ids.find(name);
+    if (it == ids.end()) {
+        it = ids.emplace(name, Entry{nextId++, time}).first;
+        changed = true;
+    }
+
+    it->second.lastUsed = time;
+
+    return it->second.id;
+}
+
+void NameTable::expire(const long before) {
+    for (auto it = ids.begin(); it != ids.end();) {
+        if (it->second.lastUsed < before) {
+            it = ids.erase(it);
+            changed = true;
+        } else {
+            ++it;
+        }
+    }
+}
+
+// the table is copied only when a string came or went, not every sample
+void NameTable::publish() {
+    if (!changed)
+        return;
+
+    auto next = std::make_shared<Names>();
+    next->strings.reserve(ids.size());
+    for (const auto &entry : ids)
+        next->strings.emplace(entry.second.id, entry.first);
+
+    names.store(std::move(next));
+    changed = false;
+}
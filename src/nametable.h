@@ -0,0 +1,52 @@
+#ifndef NAMETABLE_H
+#define NAMETABLE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "snapshot.h"
+
+/**
+ * Interned strings: every distinct string is stored once and referred to by
+ * its id. One thread interns, it publishes the table as an immutable
+ * snapshot that readers share without a lock. Ids are never reused, so an id
+ * always resolves to the same string in any snapshot that still has it
+ */
+class NameTable {
+public:
+    struct Names {
+        std::unordered_map<uint32_t, std::string> strings; // id -> string
+
+        // empty if the id was dropped before this snapshot
+        const std::string& get(uint32_t id) const;
+    };
+
+    // time - ms, the string is kept at least until expire() is given a later time
+    uint32_t intern(const std::string &name, long time);
+
+    // drops the strings not interned since before
+    void expire(long before);
+
+    // publishes what intern() and expire() changed
+    void publish();
+
+    // never blocks, for any thread
+    std::shared_ptr<const Names> load() const { return names.load(); }
+
+private:
+    struct Entry {
+        uint32_t id;
+        long lastUsed;
+    };
+
+    // only the interning thread touches these
+    std::unordered_map<std::string, Entry> ids;
+    uint32_t nextId = 0;
+    bool changed = false;
+
+    Snapshot<Names> names;
+};
+
+#endif
@@ -0,0 +1,122 @@
+#include "nvidiasmi.h"
+
+#include <algorithm>
+
+#include "constants.h"
+#include "settings.h"
+#include "utils.h"
+#include "parser.h"
+
+NvidiaSmiSource::~NvidiaSmiSource() {
+    delete gpuStream;
+    delete processStream;
+}
+
+// a stopped stream is started again by the next sample, at the new rate; while paused there is none
+void NvidiaSmiSource::setGPUInterval(const uint interval) {
+    delete gpuStream;
+    gpuStream = nullptr;
+    gpuInterval = interval;
+}
+
+void NvidiaSmiSource::setProcessesInterval(const uint interval) {
+    delete processStream;
+    processStream = nullptr;
+    pendingCount = 0;
+    pendingTime.clear();
+    processesInterval = interval;
+}
+
+bool NvidiaSmiSource::sampleGPUs(std::vector<GPUSample> &gpus) {
+    if (STREAMING) {
+        long interval = gpuInterval > 0 ? gpuInterval : UPDATE_DELAY;
+        if (!gpuStream)
+            gpuStream = new StreamReader(NVSMI_CMD_GPU_QUERY_STREAM + std::to_string(interval),
+                    std::max<long>(NVSM_EXEC_TIMEOUT, NVSM_STREAM_TIMEOUT_INTERVALS * interval));
+
+        // every loop prints all GPUs in index order, an index that is not higher than the previous
+        // one starts the next loop; GPUs beyond the last index of the previous loop are gone
+        gpuStream->poll([this, &gpus](std::string_view line) {
+            size_t index;
+            if (!parseGPUQueryLine(line, gpus, &index))
+                return;
+
+            if (index <= lastGPUIndex)
+                gpus.resize(lastGPUIndex + 1);
+            lastGPUIndex = index;
+        });
+
+        // a running nvidia-smi that stopped printing keeps the old values
+        return gpuStream->isRunning() && getTime() - gpuStream->getLastRead() <= NVSM_STALE_INTERVALS * interval;
+    }
+
+    ExecResult result = run(NVSMI_CMD_GPU_QUERY);
+    if (!result.ok())
+        return false;
+
+    size_t count = 0;
+    forEachLine(result.out, [&](std::string_view line) {
+        if (parseGPUQueryLine(line, gpus))
+            count++;
+    });
+    gpus.resize(count);
+
+    return count != 0;
+}
+
+bool NvidiaSmiSource::sampleProcesses(std::vector<ProcessSample> &processes) {
+    if (!STREAMING) {
+        ExecResult result = run(NVSMI_CMD_PROCESSES);
+        if (!result.ok())
+            return false;
+
+        size_t count = 0;
+
+        // parse into the existing elements, so their strings are reused
+        forEachLine(result.out, [&](std::string_view line) {
+            if (count == processes.size())
+                processes.emplace_back();
+            if (parsePmonLine(line, processes[count]))
+                count++;
+        });
+        processes.resize(count);
+
+        return true;
+    }
+
+    if (!processStream) {
+        uint seconds = (processesInterval > 0 ? processesInterval : PROCESSES_INTERVAL) / 1000;
+        seconds = std::min<uint>(NVSM_PMON_DELAY_MAX, std::max(1u, seconds));
+        processStream = new StreamReader(NVSMI_CMD_PROCESSES_STREAM + std::to_string(seconds),
+                std::max<long>(NVSM_EXEC_TIMEOUT, NVSM_STREAM_TIMEOUT_INTERVALS * seconds * 1000L));
+    }
+
+    // `pmon -o T` prints one line per process, and all lines of one sample share
+    // the same time column, so a sample is complete when the time changes
+    bool updated = false;
+    std::string_view time;
+
+    processStream->poll([&](std::string_view line) {
+        if (!parsePmonLine(line, current, &time))
+            return;
+
+        if (time != pendingTime) {
+            if (!pendingTime.empty()) {
+                pending.resize(pendingCount);
+                processes.swap(pending); // old elements come back to pending for reuse
+                updated = true;
+            }
+            pendingCount = 0;
+            pendingTime.assign(time.data(), time.size());
+        }
+
+        // copy assignment keeps the capacity of the existing strings
+        if (pendingCount == pending.size())
+            pending.push_back(current);
+        else
+            pending[pendingCount] = current;
+        pendingCount++;
+    });
+
+    return updated;
+}
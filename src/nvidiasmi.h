@@ -0,0 +1,35 @@
+#ifndef NVIDIASMI_H
+#define NVIDIASMI_H
+
+#include "source.h"
+#include "stream.h"
+
+/**
+ * Scrapes the text output of nvidia-smi, either by running it for every
+ * sample or, in streaming mode, by keeping it running with --loop-ms / pmon -d
+ */
+class NvidiaSmiSource : public MetricsSource {
+public:
+    ~NvidiaSmiSource() override;
+
+    const char* getName() const override { return "nvidia-smi"; }
+
+    bool sampleGPUs(std::vector<GPUSample> &gpus) override;
+    bool sampleProcesses(std::vector<ProcessSample> &processes) override;
+
+    void setGPUInterval(uint interval) override;
+    void setProcessesInterval(uint interval) override;
+
+private:
+    StreamReader *gpuStream = nullptr;
+    StreamReader *processStream = nullptr;
+    size_t lastGPUIndex = 0; // of the last line the GPU stream printed
+    uint gpuInterval = 0, processesInterval = 0; // of the streams, 0 - UPDATE_DELAY / PROCESSES_INTERVAL
+    // streaming mode: sample that is still being received
+    std::vector<ProcessSample> pending;
+    size_t pendingCount = 0;
+    std::string pendingTime;
+    ProcessSample current;
+};
+
+#endif
@@ -0,0 +1,345 @@
+#include "nvml.h"
+
+#include <iostream>
+#include <fstream>
+#include <dlfcn.h>
+
+#include "constants.h"
+
+// subset of nvml.h, so NVML headers are not needed to build
+typedef struct nvmlDevice_st *nvmlDevice_t;
+typedef int nvmlReturn_t;
+
+#define NVML_SUCCESS 0
+#define NVML_ERROR_NOT_FOUND 6
+#define NVML_ERROR_INSUFFICIENT_SIZE 7
+#define NVML_DEVICE_NAME_BUFFER_SIZE 96
+#define NVML_DEVICE_UUID_V2_BUFFER_SIZE 96
+
+struct nvmlUtilization_t {
+    unsigned int gpu, memory; // %
+};
+
+struct nvmlMemory_t {
+    unsigned long long total, free, used; // bytes
+};
+
+// nvmlProcessInfo_v1_t, used by the unversioned nvmlDevice*RunningProcesses
+struct nvmlProcessInfoV1 {
+    unsigned int pid;
+    unsigned long long usedGpuMemory;
+};
+
+// nvmlProcessInfo_t, used by the _v2 and _v3 variants
+struct nvmlProcessInfoV2 {
+    unsigned int pid;
+    unsigned long long usedGpuMemory;
+    unsigned int gpuInstanceId, computeInstanceId;
+};
+
+// nvmlProcessUtilizationSample_t, the encoder and decoder columns of pmon come from here too
+struct nvmlProcessUtilizationSample {
+    unsigned int pid;
+    unsigned long long timeStamp; // us
+    unsigned int smUtil, memUtil, encUtil, decUtil; // %
+};
+
+template<typename Info>
+using nvmlRunningProcesses_t = nvmlReturn_t (*)(nvmlDevice_t, unsigned int*, Info*);
+
+struct NVMLSymbols {
+    nvmlReturn_t (*init)();
+    nvmlReturn_t (*shutdown)();
+    nvmlReturn_t (*getCount)(unsigned int*);
+    nvmlReturn_t (*getHandleByIndex)(unsigned int, nvmlDevice_t*);
+    nvmlReturn_t (*getName)(nvmlDevice_t, char*, unsigned int);
+    nvmlReturn_t (*getUUID)(nvmlDevice_t, char*, unsigned int); // optional
+    nvmlReturn_t (*getUtilizationRates)(nvmlDevice_t, nvmlUtilization_t*);
+    nvmlReturn_t (*getMemoryInfo)(nvmlDevice_t, nvmlMemory_t*);
+    nvmlRunningProcesses_t<nvmlProcessInfoV2> getComputeProcesses, getGraphicsProcesses;
+    nvmlRunningProcesses_t<nvmlProcessInfoV1> getComputeProcessesV1, getGraphicsProcessesV1;
+    nvmlReturn_t (*getProcessUtilization)(nvmlDevice_t, nvmlProcessUtilizationSample*, unsigned int*, unsigned long long); // optional
+
+    std::vector<nvmlProcessInfoV2> processes; // reused between samples
+    std::vector<nvmlProcessInfoV1> processesV1;
+    std::vector<nvmlProcessUtilizationSample> utilization;
+
+    // name and UUID are only read when the handle at an index changes
+    struct Device {
+        nvmlDevice_t handle = nullptr;
+        std::string name, uuid;
+    };
+    std::vector<Device> devices; // by index
+
+    // sampleProcesses() may run on another thread than sampleGPUs(), so it has its own
+    struct ProcessDevice {
+        nvmlDevice_t handle = nullptr;
+        unsigned long long lastSeen = 0; // timestamp of the newest process utilization sample read
+    };
+    std::vector<ProcessDevice> processDevices; // by index
+};
+
+// returns the first of the given (versioned) names the library exports
+template<typename T>
+static T resolve(void *library, std::initializer_list<const char*> names) {
+    for (const char *name : names)
+        if (void *symbol = dlsym(library, name))
+            return reinterpret_cast<T>(symbol);
+
+    return nullptr;
+}
+
+static std::string processName(const std::string &procRoot, unsigned int pid) {
+    std::ifstream comm(procRoot + "/" + std::to_string(pid) + "/comm");
+    std::string name;
+
+    if (!std::getline(comm, name) || name.empty())
+        return "-";
+
+    return name;
+}
+
+template<typename Info>
+static bool runningProcesses(nvmlRunningProcesses_t<Info> fn, nvmlDevice_t device, std::vector<Info> &infos, unsigned int &count) {
+    if (infos.empty())
+        infos.resize(NVSM_NVML_PROCESSES);
+
+    nvmlReturn_t result;
+    while (true) {
+        count = infos.size();
+        result = fn(device, &count, infos.data());
+        if (result != NVML_ERROR_INSUFFICIENT_SIZE)
+            return result == NVML_SUCCESS;
+
+        // count now holds the required size, processes may start in between
+        infos.resize(count > infos.size() ? count : infos.size() * 2);
+    }
+}
+
+template<typename Info>
+static void addProcesses(nvmlRunningProcesses_t<Info> fn, nvmlDevice_t device, int GPUIndex, const char *type,
+                         std::vector<Info> &infos, std::vector<ProcessSample> &processes, size_t deviceBegin,
+                         const std::string &procRoot)
+{
+    unsigned int count;
+    if (!fn || !runningProcesses(fn, device, infos, count))
+        return;
+
+    for (unsigned int i = 0; i < count; i++) {
+        int fb = static_cast<int>(infos[i].usedGpuMemory / 1024 / 1024);
+
+        // a process that is both compute and graphics is reported by both calls
+        bool merged = false;
+        for (size_t p = deviceBegin; p < processes.size(); p++) {
+            if (processes[p].pid == static_cast<int>(infos[i].pid)) {
+                processes[p].type = "C+G";
+                merged = true;
+                break;
+            }
+        }
+
+        if (merged)
+            continue;
+
+        ProcessSample process;
+        process.GPUIndex = GPUIndex;
+        process.pid = infos[i].pid;
+        process.type = type;
+        process.name = processName(procRoot, infos[i].pid);
+        process.fb = fb;
+        processes.push_back(process);
+    }
+}
+
+/**
+ * Fills sm, mem, enc and dec of the processes of a device from the samples
+ * NVML took since the last call, the newest one of a process wins. A process
+ * without a sample since then was idle, like a "-" row of pmon
+ */
+static void addUtilization(NVMLSymbols *nvml, NVMLSymbols::ProcessDevice &cached, std::vector<ProcessSample> &processes, size_t deviceBegin) {
+    if (!nvml->getProcessUtilization || deviceBegin == processes.size())
+        return;
+
+    auto &samples = nvml->utilization;
+    if (samples.empty())
+        samples.resize(NVSM_NVML_PROCESSES);
+
+    unsigned int count;
+    nvmlReturn_t result;
+    while (true) {
+        count = samples.size();
+        result = nvml->getProcessUtilization(cached.handle, samples.data(), &count, cached.lastSeen);
+        if (result != NVML_ERROR_INSUFFICIENT_SIZE)
+            break;
+        samples.resize(count > samples.size() ? count : samples.size() * 2);
+    }
+
+    if (result == NVML_ERROR_NOT_FOUND)
+        count = 0; // nothing ran since lastSeen
+    else if (result != NVML_SUCCESS)
+        return; // not supported on this device, stays NVSM_NA
+
+    for (size_t p = deviceBegin; p < processes.size(); p++) {
+        ProcessSample &process = processes[p];
+        process.sm = process.mem = process.enc = process.dec = 0;
+
+        unsigned long long newest = 0;
+        for (unsigned int i = 0; i < count; i++) {
+            const nvmlProcessUtilizationSample &sample = samples[i];
+            if (static_cast<int>(sample.pid) != process.pid || sample.timeStamp < newest)
+                continue;
+
+            newest = sample.timeStamp;
+            process.sm = sample.smUtil;
+            process.mem = sample.memUtil;
+            process.enc = sample.encUtil;
+            process.dec = sample.decUtil;
+        }
+    }
+
+    for (unsigned int i = 0; i < count; i++)
+        if (samples[i].timeStamp > cached.lastSeen)
+            cached.lastSeen = samples[i].timeStamp;
+}
+
+NVMLSource::NVMLSource(const std::string &library, const std::string &procRoot) : procRoot(procRoot) {
+    this->library = dlopen(library.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (!this->library) {
+        std::cout << "NVML: " << dlerror() << "\n";
+        return;
+    }
+
+    nvml = new NVMLSymbols();
+    nvml->init = resolve<decltype(nvml->init)>(this->library, {"nvmlInit_v2", "nvmlInit"});
+    nvml->shutdown = resolve<decltype(nvml->shutdown)>(this->library, {"nvmlShutdown"});
+    nvml->getCount = resolve<decltype(nvml->getCount)>(this->library, {"nvmlDeviceGetCount_v2", "nvmlDeviceGetCount"});
+    nvml->getHandleByIndex = resolve<decltype(nvml->getHandleByIndex)>(this->library, {"nvmlDeviceGetHandleByIndex_v2", "nvmlDeviceGetHandleByIndex"});
+    nvml->getName = resolve<decltype(nvml->getName)>(this->library, {"nvmlDeviceGetName"});
+    nvml->getUUID = resolve<decltype(nvml->getUUID)>(this->library, {"nvmlDeviceGetUUID"});
+    nvml->getUtilizationRates = resolve<decltype(nvml->getUtilizationRates)>(this->library, {"nvmlDeviceGetUtilizationRates"});
+    nvml->getMemoryInfo = resolve<decltype(nvml->getMemoryInfo)>(this->library, {"nvmlDeviceGetMemoryInfo"});
+    nvml->getComputeProcesses = resolve<decltype(nvml->getComputeProcesses)>(this->library,
+            {"nvmlDeviceGetComputeRunningProcesses_v3", "nvmlDeviceGetComputeRunningProcesses_v2"});
+    nvml->getGraphicsProcesses = resolve<decltype(nvml->getGraphicsProcesses)>(this->library,
+            {"nvmlDeviceGetGraphicsRunningProcesses_v3", "nvmlDeviceGetGraphicsRunningProcesses_v2"});
+    nvml->getComputeProcessesV1 = resolve<decltype(nvml->getComputeProcessesV1)>(this->library, {"nvmlDeviceGetComputeRunningProcesses"});
+    nvml->getGraphicsProcessesV1 = resolve<decltype(nvml->getGraphicsProcessesV1)>(this->library, {"nvmlDeviceGetGraphicsRunningProcesses"});
+    nvml->getProcessUtilization = resolve<decltype(nvml->getProcessUtilization)>(this->library, {"nvmlDeviceGetProcessUtilization"});
+
+    bool resolved = nvml->init && nvml->shutdown && nvml->getCount && nvml->getHandleByIndex &&
+                    nvml->getName && nvml->getUtilizationRates && nvml->getMemoryInfo &&
+                    (nvml->getComputeProcesses || nvml->getComputeProcessesV1);
+
+    if (!resolved || nvml->init() != NVML_SUCCESS) {
+        std::cout << "NVML: " << library << (resolved ? " could not be initialized" : " misses required symbols") << "\n";
+        delete nvml;
+        nvml = nullptr;
+        dlclose(this->library);
+        this->library = nullptr;
+    }
+}
+
+NVMLSource::~NVMLSource() {
+    if (nvml) {
+        nvml->shutdown();
+        delete nvml;
+    }
+
+    if (library)
+        dlclose(library);
+}
+
+bool NVMLSource::isAvailable() const {
+    return nvml != nullptr;
+}
+
+int NVMLSource::getGPUCount() const {
+    unsigned int count;
+    if (!nvml || nvml->getCount(&count) != NVML_SUCCESS)
+        return 0;
+
+    return count;
+}
+
+bool NVMLSource::sampleGPUs(std::vector<GPUSample> &gpus) {
+    unsigned int count;
+    if (!nvml || nvml->getCount(&count) != NVML_SUCCESS)
+        return false;
+
+    gpus.resize(count);
+    nvml->devices.resize(count);
+
+    nvmlDevice_t device;
+    nvmlUtilization_t utilization;
+    nvmlMemory_t memory;
+    char name[NVML_DEVICE_NAME_BUFFER_SIZE];
+    char uuid[NVML_DEVICE_UUID_V2_BUFFER_SIZE];
+
+    for (unsigned int i = 0; i < count; i++) {
+        if (nvml->getHandleByIndex(i, &device) != NVML_SUCCESS)
+            continue;
+
+        GPUSample &gpu = gpus[i];
+        NVMLSymbols::Device &cached = nvml->devices[i];
+
+        if (cached.handle != device) {
+            cached.handle = device;
+            cached.name = nvml->getName(device, name, sizeof name) == NVML_SUCCESS ? name : "";
+            cached.uuid = nvml->getUUID && nvml->getUUID(device, uuid, sizeof uuid) == NVML_SUCCESS ? uuid : "";
+        }
+
+        gpu.name = cached.name;
+        gpu.uuid = cached.uuid;
+
+        if (nvml->getUtilizationRates(device, &utilization) == NVML_SUCCESS) {
+            gpu.utilization = utilization.gpu;
+            gpu.memoryUtilization = utilization.memory;
+        }
+
+        if (nvml->getMemoryInfo(device, &memory) == NVML_SUCCESS) {
+            gpu.memoryTotal = static_cast<int>(memory.total / 1024 / 1024);
+            gpu.memoryFree = static_cast<int>(memory.free / 1024 / 1024);
+            gpu.memoryUsed = static_cast<int>(memory.used / 1024 / 1024);
+        }
+    }
+
+    return true;
+}
+
+bool NVMLSource::sampleProcesses(std::vector<ProcessSample> &processes) {
+    unsigned int count;
+    if (!nvml || nvml->getCount(&count) != NVML_SUCCESS)
+        return false;
+
+    processes.clear();
+    nvml->processDevices.resize(count);
+
+    nvmlDevice_t device;
+    for (unsigned int i = 0; i < count; i++) {
+        if (nvml->getHandleByIndex(i, &device) != NVML_SUCCESS)
+            continue;
+
+        size_t deviceBegin = processes.size();
+
+        if (nvml->getComputeProcesses)
+            addProcesses(nvml->getComputeProcesses, device, i, "C", nvml->processes, processes, deviceBegin, procRoot);
+        else
+            addProcesses(nvml->getComputeProcessesV1, device, i, "C", nvml->processesV1, processes, deviceBegin, procRoot);
+
+        if (nvml->getGraphicsProcesses)
+            addProcesses(nvml->getGraphicsProcesses, device, i, "G", nvml->processes, processes, deviceBegin, procRoot);
+        else
+            addProcesses(nvml->getGraphicsProcessesV1, device, i, "G", nvml->processesV1, processes, deviceBegin, procRoot);
+
+        // the samples NVML keeps since lastSeen belong to the device at this index
+        NVMLSymbols::ProcessDevice &cached = nvml->processDevices[i];
+        if (cached.handle != device) {
+            cached.handle = device;
+            cached.lastSeen = 0;
+        }
+
+        addUtilization(nvml, cached, processes, deviceBegin);
+    }
+
+    return true;
+}
@@ -0,0 +1,34 @@
+#ifndef NVML_H
+#define NVML_H
+
+#include "constants.h"
+#include "source.h"
+
+struct NVMLSymbols;
+
+/**
+ * Reads GPU and process data in-process through NVML. libnvidia-ml is
+ * loaded with dlopen, so the app still starts (and falls back to
+ * nvidia-smi) on machines without it
+ */
+class NVMLSource : public MetricsSource {
+public:
+    // procRoot - where the names of the processes are read from, see ProcFS
+    explicit NVMLSource(const std::string &library, const std::string &procRoot = NVSM_PROCFS_ROOT);
+    ~NVMLSource() override;
+
+    const char* getName() const override { return "NVML"; }
+
+    bool isAvailable() const;
+    int getGPUCount() const;
+
+    bool sampleGPUs(std::vector<GPUSample> &gpus) override;
+    bool sampleProcesses(std::vector<ProcessSample> &processes) override;
+
+private:
+    void *library = nullptr;
+    NVMLSymbols *nvml = nullptr;
+    std::string procRoot;
+};
+
+#endif
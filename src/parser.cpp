@@ -0,0 +1,115 @@
+#include "parser.h"
+
+#include <charconv>
+
+#include "constants.h"
+
+static bool isSpace(const char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+static std::string_view trim(std::string_view s) {
+    while (!s.empty() && isSpace(s.front()))
+        s.remove_prefix(1);
+    while (!s.empty() && isSpace(s.back()))
+        s.remove_suffix(1);
+    return s;
+}
+
+bool nextField(std::string_view &rest, std::string_view &field, const char delimiter) {
+    if (rest.empty())
+        return false;
+
+    size_t end = rest.find(delimiter);
+    field = trim(rest.substr(0, end));
+    rest = end == std::string_view::npos ? std::string_view() : rest.substr(end + 1);
+
+    return true;
+}
+
+bool nextWord(std::string_view &rest, std::string_view &word) {
+    size_t begin = 0;
+    while (begin < rest.size() && isSpace(rest[begin]))
+        begin++;
+
+    if (begin == rest.size()) {
+        rest = std::string_view();
+        return false;
+    }
+
+    size_t end = begin;
+    while (end < rest.size() && !isSpace(rest[end]))
+        end++;
+
+    word = rest.substr(begin, end - begin);
+    rest.remove_prefix(end);
+
+    return true;
+}
+
+int parseInt(std::string_view value, const int fallback) {
+    int result;
+    auto r = std::from_chars(value.data(), value.data() + value.size(), result);
+    return r.ec == std::errc() ? result : fallback;
+}
+
+bool parseGPUQueryLine(std::string_view line, std::vector<GPUSample> &gpus, size_t *parsedIndex) {
+    std::string_view field[NVSMI_QUERY_COLUMNS];
+
+    for (std::string_view &f : field)
+        if (!nextField(line, f))
+            return false;
+
+    // a garbled index must not grow gpus without bound
+    int index = parseInt(field[NVSMI_QUERY_INDEX]);
+    if (index < 0 || index >= NVSM_GPUS_MAX)
+        return false;
+
+    if ((size_t) index >= gpus.size())
+        gpus.resize(index + 1);
+
+    GPUSample &gpu = gpus[index];
+    gpu.name.assign(field[NVSMI_QUERY_NAME].data(), field[NVSMI_QUERY_NAME].size());
+    gpu.utilization = parseInt(field[NVSMI_QUERY_GPU], 0);
+    gpu.memoryUtilization = parseInt(field[NVSMI_QUERY_MEM], 0);
+    gpu.memoryTotal = parseInt(field[NVSMI_QUERY_TOTAL], 0);
+    gpu.memoryFree = parseInt(field[NVSMI_QUERY_FREE], 0);
+    gpu.memoryUsed = parseInt(field[NVSMI_QUERY_USED], 0);
+
+    std::string_view uuid;
+    if (nextField(line, uuid))
+        gpu.uuid.assign(uuid.data(), uuid.size());
+    else
+        gpu.uuid.clear();
+
+    if (parsedIndex)
+        *parsedIndex = index;
+
+    return true;
+}
+
+bool parsePmonLine(std::string_view line, ProcessSample &process, std::string_view *time) {
+    std::string_view word[NVSMI_COLUMNS];
+
+    if (time && !nextWord(line, *time))
+        return false;
+
+    for (std::string_view &w : word)
+        if (!nextWord(line, w))
+            return false;
+
+    if (word[0].front() == '#' || (time && time->front() == '#'))
+        return false;
+
+    process.GPUIndex = parseInt(word[NVSMI_GPUINDEX], 0);
+    process.pid = parseInt(word[NVSMI_PID]);
+    process.type.assign(word[NVSMI_TYPE].data(), word[NVSMI_TYPE].size());
+    process.name.assign(word[NVSMI_NAME].data(), word[NVSMI_NAME].size());
+    process.sm = parseInt(word[NVSMI_SM]);
+    process.mem = parseInt(word[NVSMI_MEM]);
+    process.enc = parseInt(word[NVSMI_ENC]);
+    process.dec = parseInt(word[NVSMI_DEC]);
+    process.fb = parseInt(word[NVSMI_FB]);
+
+    return true;
+}
@@ -0,0 +1,45 @@
+#ifndef PARSER_H
+#define PARSER_H
+
+#include <string_view>
+#include <vector>
+
+#include "source.h"
+
+/**
+ * Single pass, allocation free parsers for nvidia-smi output. Results are
+ * written into existing structs, so in steady state (same GPUs, same
+ * processes) parsing does not touch the heap
+ */
+
+// calls onLine for every line of text, without the '\n'
+template<typename F>
+void forEachLine(std::string_view text, F &&onLine) {
+    size_t begin = 0, end;
+    while ((end = text.find('\n', begin)) != std::string_view::npos) {
+        onLine(text.substr(begin, end - begin));
+        begin = end + 1;
+    }
+
+    if (begin < text.size())
+        onLine(text.substr(begin));
+}
+
+// next comma (or delimiter) separated field with surrounding spaces trimmed
+bool nextField(std::string_view &rest, std::string_view &field, char delimiter = ',');
+
+// next whitespace separated word
+bool nextWord(std::string_view &rest, std::string_view &word);
+
+// returns fallback for anything that is not a number, e.g. "-" or "[N/A]"
+int parseInt(std::string_view value, int fallback = NVSM_NA);
+
+// one line of --query-gpu=index,name,...[,uuid] --format=csv,noheader,nounits,
+// gpus grows if the line has a new index, which parsedIndex receives if it is not nullptr
+bool parseGPUQueryLine(std::string_view line, std::vector<GPUSample> &gpus, size_t *parsedIndex = nullptr);
+
+// one line of `pmon -s mu`, time receives the leading time column of `pmon -o T`
+// if it is not nullptr; header lines and malformed lines return false
+bool parsePmonLine(std::string_view line, ProcessSample &process, std::string_view *time = nullptr);
+
+#endif
@@ -1,87 +1,225 @@
 #include "processes.h"
-#include <QStandardItem>
 #include <QHeaderView>
 #include <QMenu>
 #include <QMouseEvent>
 #include <QMutexLocker>
-#include "constants.h"
+#include <QPainter>
+#include "rowdiff.h"
+#include "settings.h"
 #include "utils.h"
 
-ProcessList::ProcessList(const std::string& name, const std::string& type,
-						 const std::string& gpuIdx, const std::string& pid,
-						 const std::string& sm, const std::string& mem,
-						 const std::string& enc, const std::string& dec,
-						 const std::string& vRAM, const std::string& GPUName)
-{
-	this->name = name;
-	if (type.length() > 1)
-		this->type = std::string("Compute + Graphics");
-	else
-		this->type = type.compare("G") == 0 ? std::string("Graphics") : std::string("Compute");
-	this->GPUIndex = gpuIdx;
-	this->pid = pid;
-	this->computeUse = sm;
-	this->memoryUse = mem;
-	this->encoding = enc;
-	this->decoding = dec;
-	this->vRAM = vRAM;
-	this->vRAM.append(" MB");
-	this->computeUse.append(" %");
-	this->GPUName = GPUName;
-}
-
-void ProcessesWorker::work() {
-	mutex.lock();
-	std::vector<std::string> lines = split(streamline(exec(NVSMI_CMD_PROCESSES)), "\n");
-	std::vector<std::string> GPUs = split(streamline(exec(NVSMI_LIST_GPUS)), "\n");
-	std::vector<std::string> data;
-	processes.clear();
-
-	for (size_t line = 2; line < lines.size(); line++) {
-		if (lines[line].empty())
+#include <algorithm>
+#include <unordered_map>
+
+// formats a value the way pmon does: "-" if it is not available
+static QString format(const int value, const char *unit = "") {
+	return value == NVSM_NA ? QString("-") : QString::number(value) + unit;
+}
+
+ProcessesModel::ProcessesModel(QObject *parent) : QAbstractTableModel(parent) {}
+
+int ProcessesModel::rowCount(const QModelIndex &parent) const {
+	return parent.isValid() ? 0 : rows.size();
+}
+
+int ProcessesModel::columnCount(const QModelIndex &parent) const {
+	return parent.isValid() ? 0 : NVSM_COLUMNS;
+}
+
+// min / avg / max of the values that are available, "-" if none is
+template<typename F>
+static QString summary(const ProcessTrend &points, F value, const char *unit) {
+	int min = 0, max = 0, count = 0;
+	long sum = 0;
+
+	for (const ProcessPoint &point : points) {
+		int v = value(point);
+		if (v == NVSM_NA)
 			continue;
 
-		data = split(lines[line], " ");
+		min = count == 0 ? v : std::min(min, v);
+		max = count == 0 ? v : std::max(max, v);
+		sum += v;
+		count++;
+	}
+
+	if (count == 0)
+		return QString("-");
+
+	return QString::number(min) + " / " + QString::number((double) sum / count, 'f', 1) + " / " +
+		QString::number(max) + unit;
+}
+
+QVariant ProcessesModel::data(const QModelIndex &index, int role) const {
+	if (!index.isValid() || index.row() >= (int) rows.size())
+		return QVariant();
 
-		processes.emplace_back(data[NVSMI_NAME], data[NVSMI_TYPE],
-							   data[NVSMI_GPUINDEX], data[NVSMI_PID],
-							   data[NVSMI_SM], data[NVSMI_MEM],
-							   data[NVSMI_ENC], data[NVSMI_DEC],
-							   data[NVSMI_FB], GPUs[std::atoi(data[NVSMI_GPUINDEX].c_str()) + 1]);
+	if (role == Qt::ForegroundRole)
+		return snapshot && snapshot->stale ? QVariant(QColor(Qt::gray)) : QVariant();
+
+	if (role == Qt::ToolTipRole && index.column() == NVSM_TREND) {
+		const ProcessTrend *points = trend(index.row());
+		if (!points || points->empty())
+			return QVariant();
+
+		return QString("Last %1 samples, min / avg / max\n").arg((int) points->size()) +
+			"Compute Use: " + summary(*points, [](const ProcessPoint &p) { return p.computeUse; }, " %") + "\n" +
+			"Memory Use: " + summary(*points, [](const ProcessPoint &p) { return p.memoryUse; }, " %") + "\n" +
+			"GPU Memory Use: " + summary(*points, [](const ProcessPoint &p) { return p.vRAM; }, " MB");
 	}
 
-	mutex.unlock();
+	static const char *types[] = {"Compute", "Graphics", "Compute + Graphics"};
+	const ProcessList &process = rows[index.row()];
+	const ProcessIdentity *identity = process.host.identity.get();
+
+	if (role == Qt::ToolTipRole && identity) {
+		switch (index.column()) {
+			case NVSM_NAME: return identity->cmdline.empty() ? QVariant() : QString(identity->cmdline.c_str());
+			case NVSM_CONTAINER: return identity->cgroup.empty() ? QVariant() : QString(identity->cgroup.c_str());
+			default: return QVariant();
+		}
+	}
 
-	dataUpdated();
+	if (role != Qt::DisplayRole)
+		return QVariant();
+
+	switch (index.column()) {
+		case NVSM_NAME: return QString(snapshot->names->get(process.name).c_str());
+		case NVSM_TYPE: return QString(types[process.type]);
+		case NVSM_GPUIDX: return QString(snapshot->names->get(process.GPUName).c_str());
+		case NVSM_PID: return format(process.pid);
+		case NVSM_SM: return format(process.computeUse, " %");
+		case NVSM_MEM: return format(process.vRAM, " MB");
+		case NVSM_ENC: return format(process.encoding);
+		case NVSM_DEC: return format(process.decoding);
+		case NVSM_USER: return QString(identity ? identity->user.c_str() : "-");
+		case NVSM_CPU: return process.host.cpu < 0 ? QString("-") : QString(toString(process.host.cpu).c_str()) + " %";
+		case NVSM_RSS: return format(process.host.rss == NVSM_PROCFS_NA ? NVSM_NA : process.host.rss / 1024, " MB");
+		case NVSM_CONTAINER: return QString(identity && !identity->container.empty() ? identity->container.c_str() : "-");
+		default: return QVariant();
+	}
 }
 
-int ProcessesWorker::processesIndexByPid(const std::string& pid) {
-	for (size_t i = 0; i < processes.size(); i++)
-		if (processes[i].pid == pid)
-			return i;
+QVariant ProcessesModel::headerData(int section, Qt::Orientation orientation, int role) const {
+	static const char *titles[NVSM_COLUMNS] = {
+		"Name", "Type", "GPU", "Process ID", "Compute Use", "GPU Memory Use", "Encoding", "Decoding", "User", "CPU", "RSS",
+		"Container", "History"
+	};
+
+	if (role != Qt::DisplayRole || orientation != Qt::Horizontal || section < 0 || section >= NVSM_COLUMNS)
+		return QVariant();
 
-	return -1;
+	return QString(titles[section]);
 }
 
-ProcessesTableView::ProcessesTableView(QWidget *parent) : QTableView(parent) {
-	worker = new ProcessesWorker;
+bool ProcessesModel::update(const std::shared_ptr<const ProcessesData> &snapshot) {
+	bool staleChanged = this->snapshot && this->snapshot->stale != snapshot->stale;
+	this->snapshot = snapshot;
 
-	auto *model = new QStandardItemModel;
- 
-	// Column titles
-	QStringList horizontalHeader;
-	horizontalHeader.append("Name");
-	horizontalHeader.append("Type");
-	horizontalHeader.append("GPU");
-	horizontalHeader.append("Process ID");
-	horizontalHeader.append("Compute Use");
-	horizontalHeader.append("GPU Memory Use");
-	horizontalHeader.append("Encoding");
-	horizontalHeader.append("Decoding");
+	// the model side of diffRows(), only rows whose values changed are repainted
+	struct Listener {
+		ProcessesModel *model;
+		bool added = false;
 
-	model->setHorizontalHeaderLabels(horizontalHeader);
+		void beginRemove(size_t first, size_t last) { model->beginRemoveRows(QModelIndex(), first, last); }
+		void endRemove(size_t first, size_t last) {
+			model->dataIndex.erase(model->dataIndex.begin() + first, model->dataIndex.begin() + last + 1);
+			model->endRemoveRows();
+		}
+
+		void kept(size_t row, size_t from, bool changed) {
+			model->dataIndex[row] = from;
+			if (changed)
+				model->dataChanged(model->index(row, 0), model->index(row, NVSM_COLUMNS - 1));
+		}
+
+		void beginInsert(size_t first, size_t last) {
+			model->beginInsertRows(QModelIndex(), first, last);
+			added = true;
+		}
+		void inserted(size_t, size_t from) { model->dataIndex.push_back(from); }
+		void endInsert() { model->endInsertRows(); }
+	} listener {this};
+
+	bool moved = diffRows(rows, snapshot->processes, listener);
+
+	// every history got a new point, all rows are greyed out or back to normal when the source stops or recovers
+	if (!rows.empty())
+		dataChanged(index(0, staleChanged ? 0 : NVSM_TREND), index(rows.size() - 1, NVSM_TREND));
+
+	if (moved)
+		reindex();
+
+	return listener.added;
+}
 
-	setModel(model);
+int ProcessesModel::rowByPid(const int pid) const {
+	auto it = pidIndex.find(pid);
+	return it != pidIndex.end() ? it->second : -1;
+}
+
+const ProcessTrend* ProcessesModel::trend(const int row) const {
+	if (row < 0 || row >= (int) rows.size() || dataIndex[row] >= snapshot->trends.size())
+		return nullptr;
+
+	return &snapshot->trends[dataIndex[row]];
+}
+
+// rows only move when rows are removed or added
+void ProcessesModel::reindex() {
+	pidIndex.clear();
+
+	for (size_t row = 0; row < rows.size(); row++)
+		pidIndex.emplace(rows[row].pid, row);
+}
+
+SparklineDelegate::SparklineDelegate(ProcessesModel *model, QObject *parent)
+	: QStyledItemDelegate(parent), model(model) {}
+
+void SparklineDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const {
+	QStyledItemDelegate::paint(painter, option, index); // background and selection
+
+	const ProcessTrend *points = model->trend(index.row());
+	if (!points || points->size() < 2)
+		return;
+
+	QRectF area = QRectF(option.rect).adjusted(2, 2, -2, -2);
+	qreal step = area.width() / (NVSM_PROCESS_HISTORY_POINTS - 1);
+	qreal x = area.right() - step * (points->size() - 1); // newest on the right edge
+
+	int vRAMMax = 1;
+	for (const ProcessPoint &point : *points)
+		vRAMMax = std::max(vRAMMax, point.vRAM);
+
+	QPolygonF compute, vRAM;
+	for (const ProcessPoint &point : *points) {
+		if (point.computeUse != NVSM_NA)
+			compute.append(QPointF(x, area.bottom() - area.height() * point.computeUse / 100));
+		if (point.vRAM != NVSM_NA)
+			vRAM.append(QPointF(x, area.bottom() - area.height() * point.vRAM / vRAMMax));
+		x += step;
+	}
+
+	painter->save();
+	painter->setRenderHint(QPainter::Antialiasing);
+	painter->setPen(QPen(QColor(0, 120, 255), 1));
+	painter->drawPolyline(vRAM);
+	painter->setPen(QPen(QColor(0, 170, 0), 1));
+	painter->drawPolyline(compute);
+	painter->restore();
+}
+
+QSize SparklineDelegate::sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const {
+	return QSize(NVSM_SPARKLINE_WIDTH, QStyledItemDelegate::sizeHint(option, index).height());
+}
+
+ProcessesTableView::ProcessesTableView(ProcessesWorker *worker, QWidget *parent) : QTableView(parent) {
+	this->worker = worker;
+
+	processesModel = new ProcessesModel(this);
+
+	setModel(processesModel);
+	setItemDelegateForColumn(NVSM_TREND, new SparklineDelegate(processesModel, this));
 	resizeRowsToContents();
 	resizeColumnsToContents();
 	setSelectionBehavior(QAbstractItemView::SelectRows);
@@ -90,30 +228,21 @@ ProcessesTableView::ProcessesTableView(QWidget *parent) : QTableView(parent) {
 	setAutoScroll(false);
 }
 
-ProcessesTableView::~ProcessesTableView() {
-	delete worker;
-}
-
 void ProcessesTableView::mousePressEvent(QMouseEvent *event) {
 	QTableView::mousePressEvent(event);
 	int row = indexAt(event->pos()).row();
 
 	if (row != -1) {
-		QMutexLocker locker(&worker->mutex);
 		setCurrentIndex(model()->index(row, 0));
-		selectedPid = worker->processes[row].pid;
+		selectedPid = processesModel->rows[row].pid;
 	} else
-		selectedPid = "";
+		selectedPid = NVSM_NA;
 
 	if (event->button() == Qt::RightButton && row != -1) {
 		QMenu contextMenu(tr("Context menu"), this);
 
-		worker->mutex.lock();
-		QAction action1(
-			("Kill " + worker->processes[row].name + " (pid " + worker->processes[row].pid + ")").c_str(),
-			this
-		);
-		worker->mutex.unlock();
+		const ProcessList &process = processesModel->rows[row];
+		QAction action1(("Kill " + processesModel->getName(process) + " (pid " + std::to_string(process.pid) + ")").c_str(), this);
 		connect(&action1, &QAction::triggered, this, &ProcessesTableView::killProcess);
 		contextMenu.addAction(&action1);
 
@@ -122,34 +251,21 @@ void ProcessesTableView::mousePressEvent(QMouseEvent *event) {
 }
 
 void ProcessesTableView::killProcess() {
-	QMutexLocker locker(&worker->mutex);
-	if (worker->processesIndexByPid(selectedPid) != -1) {
-		exec("kill " + selectedPid);
-		selectedPid = "";
+	if (selectedPid != NVSM_NA && worker->data.load()->processesIndexByPid(selectedPid) != -1) {
+		exec("kill " + std::to_string(selectedPid));
+		selectedPid = NVSM_NA;
 	}
 }
 
-#define _setItem(row, column, str) \
-	((QStandardItemModel*)model())->setItem(row, column, new QStandardItem(QString(worker->processes[i].str.c_str())))
-
 void ProcessesTableView::onDataUpdated() {
-	model()->removeRows(0, model()->rowCount());
-	QMutexLocker locker(&worker->mutex);
-
-	for (size_t i = 0; i < worker->processes.size(); i++) {
-		_setItem(i, NVSM_NAME, name);
-		_setItem(i, NVSM_TYPE, type);
-		_setItem(i, NVSM_GPUIDX, GPUName);
-		_setItem(i, NVSM_PID, pid);
-		_setItem(i, NVSM_SM, computeUse);
-		_setItem(i, NVSM_MEM, vRAM);
-		_setItem(i, NVSM_ENC, encoding);
-		_setItem(i, NVSM_DEC, decoding);
-	}
+	std::shared_ptr<const ProcessesData> data = worker->data.load();
 
-	int index = worker->processesIndexByPid(selectedPid);
-	if (index != -1)
-		setCurrentIndex(model()->index(index, 0));
+	// the selection follows its row, it only has to be restored if the row went away and came back
+	if (processesModel->update(data)) {
+		int index = processesModel->rowByPid(selectedPid);
+		if (index != -1)
+			setCurrentIndex(model()->index(index, 0));
 
-	resizeColumnsToContents();
+		resizeColumnsToContents();
+	}
 }
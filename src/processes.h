@@ -2,43 +2,75 @@
 #define PROCESSES_H
 
 #include <QTableView>
+#include <QAbstractTableModel>
+#include <QStyledItemDelegate>
 #include <QAction>
-#include <QMutex>
-#include "worker.h"
-
-struct ProcessList {
-	std::string name;
-	std::string type; // compute, graphics, or both
-	std::string GPUIndex, pid, computeUse, memoryUse, encoding, decoding, vRAM; // integers
-	std::string GPUName;
-
-	ProcessList(const std::string &name, const std::string &type,
-				const std::string &gpuIdx, const std::string &pid,
-				const std::string &sm, const std::string &mem,
-				const std::string &enc, const std::string &dec,
-				const std::string& vRAM, const std::string &GPUName);
+#include <unordered_map>
+#include "processesworker.h"
+
+/**
+ * Rows of the process table, keyed by (GPU, pid). update() diffs a new
+ * snapshot against the rows shown and reports only the rows that were
+ * removed, changed or added, so the view keeps its scroll position and
+ * selection and repaints only what changed
+ */
+class ProcessesModel : public QAbstractTableModel {
+	Q_OBJECT
+public:
+	std::vector<ProcessList> rows;
+
+	explicit ProcessesModel(QObject *parent = nullptr);
+
+	int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+	int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+	QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+	QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+	// returns true if rows were added
+	bool update(const std::shared_ptr<const ProcessesData> &snapshot);
+
+	int rowByPid(int pid) const;
+
+	// nullptr if the row has no history
+	const ProcessTrend* trend(int row) const;
+
+	const std::string& getName(const ProcessList &process) const { return snapshot->names->get(process.name); }
+
+private:
+	std::shared_ptr<const ProcessesData> snapshot; // the rows came from it
+	std::vector<size_t> dataIndex; // row -> index in snapshot
+	std::unordered_map<int, int> pidIndex; // pid -> first row
+
+	void reindex();
 };
 
-class ProcessesWorker : public Worker {
+/**
+ * Draws the history of a row: compute use on a 0 - 100 % scale, and the
+ * GPU memory used scaled to its own maximum in the window
+ */
+class SparklineDelegate : public QStyledItemDelegate {
 public:
-	std::vector<ProcessList> processes;
+	explicit SparklineDelegate(ProcessesModel *model, QObject *parent = nullptr);
+
+	void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+	QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override;
 
-	void work() override;
-	int processesIndexByPid(const std::string &pid);
+private:
+	ProcessesModel *model;
 };
 
 class ProcessesTableView : public QTableView {
 	Q_OBJECT
 public:
 	ProcessesWorker *worker;
+	ProcessesModel *processesModel;
 
-	explicit ProcessesTableView(QWidget *parent = nullptr);
-	~ProcessesTableView() override;
+	explicit ProcessesTableView(ProcessesWorker *worker, QWidget *parent = nullptr);
 
 	void mousePressEvent(QMouseEvent *event) override;
 
 private:
-	std::string selectedPid = "";
+	int selectedPid = NVSM_NA;
 
 	void killProcess();
 
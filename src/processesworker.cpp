@@ -0,0 +1,120 @@
+#include "processesworker.h"
+#include "settings.h"
+#include "utils.h"
+
+#include <algorithm>
+
+ProcessesWorker::ProcessesWorker() : procfs(PROC_ROOT), interval(PROCESSES_INTERVAL) {}
+
+void ProcessesWorker::setInterval(const uint interval) {
+	this->interval = interval;
+	lastSample = 0;
+}
+
+// nothing is locked while the source is sampled, the new data is published at once when complete
+void ProcessesWorker::work() {
+	if (sampler->source->sampleProcesses(samples)) {
+		std::shared_ptr<const GPUTopology> topology = sampler->getTopology();
+		auto next = std::make_shared<ProcessesData>();
+		next->samples = samples;
+
+		long time = getTime();
+		next->time = time;
+
+		// a process the source gave no pid for has nothing to read in procfs
+		pids.clear();
+		for (const ProcessSample &sample : samples)
+			if (sample.pid != NVSM_NA)
+				pids.push_back(sample.pid);
+		procfs.update(pids);
+
+		for (const ProcessSample &sample : samples) {
+			size_t GPUIndex = sample.GPUIndex;
+			uint32_t GPUName = names.intern(GPUIndex < topology->gpus.size() ? topology->gpus[GPUIndex].name : "", time);
+			next->processes.emplace_back(sample, names.intern(sample.name, time), GPUName, procfs.get(sample.pid));
+
+			// no process to follow, e.g. the row pmon prints for an idle GPU
+			if (sample.pid == NVSM_NA) {
+				next->trends.emplace_back();
+				continue;
+			}
+
+			next->pidIndex.emplace(sample.pid, next->processes.size() - 1);
+
+			const RingBuffer<ProcessPoint> &points = record(next->processes.back(), time).points;
+			next->trends.emplace_back(points.size());
+			for (size_t i = 0; i < points.size(); i++)
+				next->trends.back()[i] = points[i];
+		}
+
+		expire(time);
+		names.publish();
+		next->names = names.load();
+
+		accounting.update(next->processes, time);
+		for (int by = 0; by < NVSM_GROUP_MODES; by++)
+			next->groups[by] = accounting.get((GroupBy) by);
+
+		data.store(std::move(next));
+		lastSample = getTime();
+	} else if (lastSample == 0) {
+		lastSample = getTime(); // the source is starting, it has until NVSM_STALE_INTERVALS from now
+	} else if (getTime() - lastSample > NVSM_STALE_INTERVALS * (long) interval && !data.load()->stale) {
+		auto stale = std::make_shared<ProcessesData>(*data.load());
+		stale->stale = true;
+		data.store(std::move(stale));
+	}
+
+	dataUpdated();
+}
+
+int ProcessesData::processesIndexByPid(const int pid) const {
+	auto it = pidIndex.find(pid);
+	return it != pidIndex.end() ? it->second : -1;
+}
+
+const ProcessesWorker::History& ProcessesWorker::record(const ProcessList &process, const long time) {
+	auto it = history.find(process.key());
+	if (it == history.end()) {
+		it = history.emplace(process.key(), History()).first;
+		it->second.points.setCapacity(NVSM_PROCESS_HISTORY_POINTS);
+	}
+
+	it->second.points.push_back({process.computeUse, process.memoryUse, process.vRAM});
+	it->second.lastSeen = time;
+
+	return it->second;
+}
+
+// forgets processes and names gone for NVSM_PROCESS_HISTORY_EXPIRY, and the least recently
+// seen processes above NVSM_PROCESS_HISTORY_MAX, so short-lived processes can not grow the maps
+void ProcessesWorker::expire(const long time) {
+	names.expire(time - NVSM_PROCESS_HISTORY_EXPIRY);
+
+	for (auto it = history.begin(); it != history.end();) {
+		if (time - it->second.lastSeen > NVSM_PROCESS_HISTORY_EXPIRY)
+			it = history.erase(it);
+		else
+			++it;
+	}
+
+	if (history.size() <= NVSM_PROCESS_HISTORY_MAX)
+		return;
+
+	std::vector<long> seen;
+	seen.reserve(history.size());
+	for (const auto &entry : history)
+		seen.push_back(entry.second.lastSeen);
+
+	// everything seen at the cutoff stays, the processes of the current sample share one time
+	size_t excess = history.size() - NVSM_PROCESS_HISTORY_MAX;
+	std::nth_element(seen.begin(), seen.begin() + excess - 1, seen.end());
+	long cutoff = seen[excess - 1];
+
+	for (auto it = history.begin(); it != history.end();) {
+		if (it->second.lastSeen <= cutoff && it->second.lastSeen != time)
+			it = history.erase(it);
+		else
+			++it;
+	}
+}
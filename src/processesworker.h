@@ -0,0 +1,68 @@
+#ifndef PROCESSESWORKER_H
+#define PROCESSESWORKER_H
+
+#include <unordered_map>
+#include "worker.h"
+#include "ringbuffer.h"
+#include "nametable.h"
+#include "snapshot.h"
+#include "processlist.h"
+#include "accounting.h"
+
+struct ProcessPoint {
+	int computeUse, memoryUse; // %, NVSM_NA if not available
+	int vRAM; // MiB, NVSM_NA if not available
+};
+
+// the last NVSM_PROCESS_HISTORY_POINTS samples of a process, oldest first
+typedef std::vector<ProcessPoint> ProcessTrend;
+
+// one complete sample of the processes, never changed once published
+struct ProcessesData {
+	std::vector<ProcessList> processes;
+	std::vector<ProcessTrend> trends; // same order as processes
+	GroupsData groups[NVSM_GROUP_MODES]; // by GroupBy
+	bool stale = false; // the source gave no new sample for NVSM_STALE_INTERVALS, this is the last one it gave
+	std::vector<ProcessSample> samples; // as received from the source
+	long time = 0; // when samples was received, 0 - nothing yet
+	std::unordered_map<int, int> pidIndex; // pid -> index in processes
+	std::shared_ptr<const NameTable::Names> names = std::make_shared<const NameTable::Names>(); // has every name of processes
+
+	int processesIndexByPid(int pid) const;
+};
+
+class ProcessesWorker : public Worker {
+public:
+	Snapshot<ProcessesData> data; // the latest complete sample, readers never wait for the source
+
+	ProcessesWorker();
+
+	void work() override;
+
+	// work() is called every interval ms from now on; the source may restart, it is not stale before it had time to
+	void setInterval(uint interval);
+
+	// processes with a history, at most NVSM_PROCESS_HISTORY_MAX
+	size_t getHistorySize() const { return history.size(); }
+
+private:
+	struct History {
+		RingBuffer<ProcessPoint> points;
+		long lastSeen;
+	};
+
+	// only work() touches these
+	std::vector<ProcessSample> samples; // filled by the source
+	ProcFS procfs;
+	NameTable names; // process and GPU names
+	Accounting accounting;
+	std::vector<int> pids;
+	long lastSample = 0; // ms
+	uint interval; // ms
+	std::unordered_map<uint64_t, History> history; // key() -> history, kept a while after the process is gone
+
+	const History& record(const ProcessList &process, long time);
+	void expire(long time);
+};
+
+#endif
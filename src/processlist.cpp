@@ -0,0 +1,26 @@
+#include "processlist.h"
+
+ProcessList::ProcessList(const ProcessSample &sample, const uint32_t name, const uint32_t GPUName, const ProcessInfo &host)
+{
+	this->name = name;
+	this->GPUName = GPUName;
+	if (sample.type.length() > 1)
+		this->type = ComputeGraphics;
+	else
+		this->type = sample.type.compare("G") == 0 ? Graphics : Compute;
+	this->GPUIndex = sample.GPUIndex;
+	this->pid = sample.pid;
+	this->computeUse = sample.sm;
+	this->memoryUse = sample.mem;
+	this->encoding = sample.enc;
+	this->decoding = sample.dec;
+	this->vRAM = sample.fb;
+	this->host = host;
+}
+
+bool ProcessList::operator==(const ProcessList &other) const {
+	return name == other.name && GPUName == other.GPUName && type == other.type && GPUIndex == other.GPUIndex &&
+		pid == other.pid && computeUse == other.computeUse && memoryUse == other.memoryUse &&
+		encoding == other.encoding && decoding == other.decoding && vRAM == other.vRAM &&
+		host.identity == other.host.identity && host.cpu == other.host.cpu && host.rss == other.host.rss;
+}
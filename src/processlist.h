@@ -0,0 +1,30 @@
+#ifndef PROCESSLIST_H
+#define PROCESSLIST_H
+
+#include <cstdint>
+#include "source.h"
+#include "procfs.h"
+
+enum ProcessType : uint8_t {
+	Compute, Graphics, ComputeGraphics
+};
+
+// raw values, they are formatted only when the table asks for them
+struct ProcessList {
+	uint32_t name, GPUName; // ids in ProcessesData::names
+	ProcessType type;
+	int GPUIndex, pid;
+	int computeUse, memoryUse, encoding, decoding; // %, NVSM_NA if not available
+	int vRAM; // MiB, NVSM_NA if not available
+	ProcessInfo host; // from procfs, empty if the process is not visible on this host
+
+	ProcessList(const ProcessSample &sample, uint32_t name, uint32_t GPUName, const ProcessInfo &host);
+
+	bool operator==(const ProcessList &other) const;
+	bool operator!=(const ProcessList &other) const { return !(*this == other); }
+
+	// (GPU, pid), a process using several GPUs has a row for each
+	uint64_t key() const { return (uint64_t) (uint32_t) GPUIndex << 32 | (uint32_t) pid; }
+};
+
+#endif
@@ -0,0 +1,189 @@
+#include "procfs.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <pwd.h>
+#include <unistd.h>
+
+// procfs files report size 0, they are read until EOF
+static bool readFile(const std::string &path, std::string &out) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+        return false;
+
+    out.clear();
+    char buffer[4096];
+    ssize_t size;
+    while ((size = read(fd, buffer, sizeof(buffer))) > 0)
+        out.append(buffer, size);
+
+    close(fd);
+
+    return size == 0;
+}
+
+static long steadyTime() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// the first run of NVSM_CONTAINER_ID_LENGTH hex digits, e.g. docker-<id>.scope or /kubepods/.../<id>
+static std::string containerId(const std::string &cgroup) {
+    size_t run = 0;
+    for (size_t i = 0; i <= cgroup.size(); i++) {
+        if (i < cgroup.size() && isxdigit((unsigned char) cgroup[i])) {
+            run++;
+            continue;
+        }
+
+        if (run == NVSM_CONTAINER_ID_LENGTH)
+            return cgroup.substr(i - run, NVSM_CONTAINER_ID_SHORT);
+        run = 0;
+    }
+
+    return "";
+}
+
+ProcFS::ProcFS(const std::string &root) : root(root) {
+    ticksPerSecond = sysconf(_SC_CLK_TCK);
+    pageSize = sysconf(_SC_PAGESIZE) / 1024;
+}
+
+void ProcFS::update(const std::vector<int> &pids) {
+    long time = steadyTime();
+
+    // rebuilt from the pids, so entries of processes that are gone can not pile up
+    std::unordered_map<int, Entry> next;
+    next.reserve(pids.size());
+
+    for (int pid : pids) {
+        if (next.count(pid)) // a process using several GPUs
+            continue;
+
+        unsigned long long startTime, cpuTime;
+        long rss;
+        if (!readStat(pid, startTime, cpuTime, rss))
+            continue;
+
+        Entry entry;
+        auto it = entries.find(pid);
+        if (it != entries.end() && it->second.startTime == startTime) {
+            entry = std::move(it->second);
+            if (time > entry.time && cpuTime >= entry.cpuTime)
+                entry.info.cpu = (cpuTime - entry.cpuTime) * 100000.0f / ticksPerSecond / (time - entry.time);
+        } else {
+            entry.info.identity = readIdentity(pid);
+            entry.startTime = startTime;
+        }
+
+        entry.cpuTime = cpuTime;
+        entry.time = time;
+        entry.info.rss = rss * pageSize;
+
+        next.emplace(pid, std::move(entry));
+    }
+
+    entries.swap(next);
+}
+
+ProcessInfo ProcFS::get(const int pid) const {
+    auto it = entries.find(pid);
+    return it != entries.end() ? it->second.info : ProcessInfo();
+}
+
+// the command name in the second field may contain spaces and parentheses, fields are counted from the last ')'
+bool ProcFS::readStat(const int pid, unsigned long long &startTime, unsigned long long &cpuTime, long &rss) const {
+    std::string stat;
+    if (!readFile(root + "/" + std::to_string(pid) + "/stat", stat))
+        return false;
+
+    size_t end = stat.rfind(')');
+    if (end == std::string::npos)
+        return false;
+
+    const char *s = stat.c_str() + end + 1;
+    unsigned long long utime = 0, stime = 0;
+    bool found = false;
+
+    for (int field = 3; field <= NVSM_PROCFS_STAT_RSS; field++) {
+        char *next;
+        while (*s == ' ')
+            s++;
+
+        if (field == NVSM_PROCFS_STAT_UTIME)
+            utime = strtoull(s, &next, 10);
+        else if (field == NVSM_PROCFS_STAT_STIME)
+            stime = strtoull(s, &next, 10);
+        else if (field == NVSM_PROCFS_STAT_STARTTIME)
+            startTime = strtoull(s, &next, 10);
+        else if (field == NVSM_PROCFS_STAT_RSS) {
+            rss = strtol(s, &next, 10);
+            found = next != s;
+        } else
+            next = (char*) strchrnul(s, ' ');
+
+        if (next == s)
+            return false;
+        s = next;
+    }
+
+    cpuTime = utime + stime;
+
+    return found;
+}
+
+std::shared_ptr<const ProcessIdentity> ProcFS::readIdentity(const int pid) {
+    auto identity = std::make_shared<ProcessIdentity>();
+    std::string dir = root + "/" + std::to_string(pid), content;
+
+    if (readFile(dir + "/status", content)) {
+        size_t uid = content.find("\nUid:");
+        if (uid != std::string::npos) {
+            identity->uid = strtoul(content.c_str() + uid + 5, nullptr, 10);
+            identity->user = userName(identity->uid);
+        }
+    }
+
+    // arguments are separated and terminated by NULs, empty for kernel threads and zombies
+    if (readFile(dir + "/cmdline", content)) {
+        while (!content.empty() && content.back() == '\0')
+            content.pop_back();
+        std::replace(content.begin(), content.end(), '\0', ' ');
+        identity->cmdline = content;
+    }
+
+    // hierarchy-ID:controllers:path lines, the unified hierarchy is "0::path"
+    if (readFile(dir + "/cgroup", content)) {
+        size_t begin = 0, end;
+        while (begin < content.size()) {
+            end = content.find('\n', begin);
+            if (end == std::string::npos)
+                end = content.size();
+
+            size_t path = content.find(':', content.find(':', begin) + 1);
+            if (path < end && (identity->cgroup.empty() || content.compare(begin, 3, "0::") == 0))
+                identity->cgroup = content.substr(path + 1, end - path - 1);
+
+            begin = end + 1;
+        }
+
+        identity->container = containerId(identity->cgroup);
+    }
+
+    return identity;
+}
+
+const std::string& ProcFS::userName(const uid_t uid) {
+    auto it = users.find(uid);
+    if (it != users.end())
+        return it->second;
+
+    passwd pwd, *result = nullptr;
+    char buffer[1024];
+    getpwuid_r(uid, &pwd, buffer, sizeof(buffer), &result);
+
+    return users.emplace(uid, result ? result->pw_name : std::to_string(uid)).first->second;
+}
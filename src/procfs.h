@@ -0,0 +1,62 @@
+#ifndef PROCFS_H
+#define PROCFS_H
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <sys/types.h>
+
+#include "constants.h"
+
+// what does not change while the process lives, shared by every snapshot that shows it
+struct ProcessIdentity {
+    uid_t uid = (uid_t) -1;
+    std::string user; // name, or the uid if it has none
+    std::string cmdline; // arguments separated by spaces
+    std::string cgroup; // path in the unified hierarchy, or in the first one listed
+    std::string container; // short id, empty if the cgroup is not a container's
+};
+
+struct ProcessInfo {
+    std::shared_ptr<const ProcessIdentity> identity; // nullptr if the process could not be read
+    float cpu = NVSM_PROCFS_NA; // % of one core since the previous update
+    long rss = NVSM_PROCFS_NA; // KiB
+};
+
+/**
+ * Reads what the host knows about processes from procfs. The identity of a
+ * pid is read once and kept until the pid is gone or reused (its start time
+ * changed), later updates only read /proc/<pid>/stat. The root is
+ * configurable, so a copy of procfs, e.g. from a container, can be read too
+ */
+class ProcFS {
+public:
+    explicit ProcFS(const std::string &root = NVSM_PROCFS_ROOT);
+
+    // rereads the given pids and forgets all others
+    void update(const std::vector<int> &pids);
+
+    // what the last update read, identity is nullptr for unknown pids
+    ProcessInfo get(int pid) const;
+
+private:
+    struct Entry {
+        ProcessInfo info;
+        unsigned long long startTime; // clock ticks after boot, tells a reused pid apart
+        unsigned long long cpuTime; // utime + stime, clock ticks
+        long time; // of cpuTime, ms, steady clock
+    };
+
+    std::string root;
+    long ticksPerSecond;
+    long pageSize; // KiB
+    std::unordered_map<int, Entry> entries;
+    std::unordered_map<uid_t, std::string> users;
+
+    bool readStat(int pid, unsigned long long &startTime, unsigned long long &cpuTime, long &rss) const;
+    std::shared_ptr<const ProcessIdentity> readIdentity(int pid);
+    const std::string& userName(uid_t uid);
+};
+
+#endif
@@ -0,0 +1,66 @@
+#include "recorder.h"
+
+#include <algorithm>
+
+#include "constants.h"
+#include "settings.h"
+
+Recorder::Recorder(const std::string &path): writer(path) {}
+
+Recorder::~Recorder() {
+    stop();
+}
+
+void Recorder::push(const long time, const std::vector<GPUSample> &gpus) {
+    if (gpus.empty())
+        return;
+
+    Sample sample;
+    sample.time = time;
+    for (const GPUSample &gpu : gpus) {
+        sample.utilization.push_back(static_cast<uint8_t>(std::clamp(gpu.utilization, 0, 100)));
+        sample.memoryUsed.push_back(std::max(gpu.memoryUsed, 0));
+    }
+
+    if (!sameGPUs(gpus, recorded)) {
+        sample.gpus = gpus;
+        recorded = gpus;
+    }
+
+    QMutexLocker locker(&mutex);
+    queue.push_back(std::move(sample));
+}
+
+void Recorder::stop() {
+    mutex.lock();
+    running = false;
+    wakeUp.wakeAll();
+    mutex.unlock();
+
+    wait();
+}
+
+void Recorder::run() {
+    std::vector<Sample> pending;
+    bool stopping = false;
+
+    mutex.lock();
+    while (!stopping) {
+        if (running)
+            wakeUp.wait(&mutex, NVSM_RECORD_FLUSH_INTERVAL);
+        stopping = !running;
+        pending.swap(queue);
+        mutex.unlock();
+
+        for (const Sample &sample : pending) {
+            if (!sample.gpus.empty())
+                writer.open(sample.gpus, UPDATE_DELAY);
+            writer.add(sample.time, sample.utilization, sample.memoryUsed);
+        }
+        writer.flush();
+
+        pending.clear();
+        mutex.lock();
+    }
+    mutex.unlock();
+}
@@ -0,0 +1,46 @@
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <string>
+#include <vector>
+
+#include "recording.h"
+
+/**
+ * Appends samples to a recording. push() only queues them, encoding and
+ * writing happen on this thread, which rewrites the block being filled
+ * every NVSM_RECORD_FLUSH_INTERVAL, so at most that much is lost on a crash.
+ * When the GPUs change, the writer starts a new segment
+ */
+class Recorder : public QThread {
+public:
+    explicit Recorder(const std::string &path);
+    ~Recorder() override;
+
+    void push(long time, const std::vector<GPUSample> &gpus);
+
+    void stop();
+
+    void run() override;
+
+private:
+    struct Sample {
+        long time;
+        std::vector<uint8_t> utilization;
+        std::vector<int> memoryUsed;
+        std::vector<GPUSample> gpus; // set on the first sample and when the GPUs changed, the writer is opened for them
+    };
+
+    RecordingWriter writer;
+
+    QMutex mutex;
+    QWaitCondition wakeUp;
+    bool running = true;
+    std::vector<Sample> queue; // guarded by mutex
+    std::vector<GPUSample> recorded; // GPUs of the last pushed sample
+};
+
+#endif
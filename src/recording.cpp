@@ -0,0 +1,453 @@
+#include "recording.h"
+
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "constants.h"
+
+static size_t varintSize(uint64_t value) {
+    size_t size = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        size++;
+    }
+    return size;
+}
+
+void putVarint(std::vector<uint8_t> &out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+bool getVarint(const uint8_t *&in, const uint8_t *end, uint64_t &value) {
+    value = 0;
+    for (int shift = 0; in < end && shift < 64; shift += 7) {
+        uint8_t byte = *in++;
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+// small negative memory deltas must stay small
+uint64_t zigzag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t unzigzag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+bool sameGPUs(const std::vector<GPUSample> &a, const std::vector<GPUSample> &b) {
+    if (a.size() != b.size())
+        return false;
+
+    auto same = [](const std::string &x, const std::string &y) {
+        return x.empty() || y.empty() || x == y;
+    };
+
+    for (size_t GPU = 0; GPU < a.size(); GPU++) {
+        if (!same(a[GPU].name, b[GPU].name) || !same(a[GPU].uuid, b[GPU].uuid))
+            return false;
+    }
+
+    return true;
+}
+
+// GPUs of a valid header block: memory totals, then names and UUIDs, the ones left out are empty
+static std::vector<GPUSample> readGPUs(const uint8_t *block, const int gpuCount) {
+    std::vector<GPUSample> gpus(gpuCount);
+
+    const uint8_t *in = block + sizeof(RecordingHeader), *end = block + NVSM_RECORD_BLOCK_SIZE;
+    for (GPUSample &gpu : gpus) {
+        int32_t total;
+        memcpy(&total, in, sizeof total);
+        gpu.memoryTotal = total;
+        in += sizeof total;
+    }
+
+    auto next = [&](std::string &out) {
+        const uint8_t *stringEnd = std::find(in, end, 0);
+        if (stringEnd == end)
+            return;
+        out.assign(reinterpret_cast<const char*>(in), stringEnd - in);
+        in = stringEnd + 1;
+    };
+
+    for (GPUSample &gpu : gpus)
+        next(gpu.name);
+    for (GPUSample &gpu : gpus)
+        next(gpu.uuid);
+
+    return gpus;
+}
+
+static bool validHeader(const RecordingHeader &header) {
+    return memcmp(header.magic, NVSM_RECORD_MAGIC, sizeof header.magic) == 0 && header.version == NVSM_RECORD_VERSION &&
+        header.gpuCount > 0 && sizeof header + header.gpuCount * sizeof(int32_t) <= NVSM_RECORD_BLOCK_SIZE;
+}
+
+RecordingWriter::RecordingWriter(const std::string &path): path(path) {}
+
+RecordingWriter::~RecordingWriter() {
+    if (fd >= 0)
+        close(fd);
+}
+
+// creates the file, or appends to it if it is a recording of the same GPUs
+bool RecordingWriter::open(const std::vector<GPUSample> &gpus, const uint interval) {
+    if (fd >= 0) {
+        flush();
+        close(fd);
+    }
+
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        std::cout << "Could not open recording " << path << "\n";
+        return false;
+    }
+
+    struct stat info {};
+    fstat(fd, &info);
+
+    if (info.st_size == 0) {
+        if (!create(gpus, interval))
+            return false;
+    } else {
+        std::vector<uint8_t> block(NVSM_RECORD_BLOCK_SIZE, 0);
+        bool complete = pread(fd, block.data(), block.size(), 0) == (ssize_t) block.size();
+
+        RecordingHeader header {};
+        memcpy(&header, block.data(), sizeof header);
+        if (!complete || !validHeader(header)) {
+            std::cout << path << " is not a recording, not recording\n";
+            close(fd);
+            fd = -1;
+            return false;
+        }
+
+        if (!sameGPUs(gpus, readGPUs(block.data(), header.gpuCount))) {
+            moveAside();
+            if (fd < 0 || !create(gpus, interval))
+                return false;
+        } else {
+            // replay sizes its buffers by the interval, so the shortest one is kept
+            if (interval < header.interval) {
+                header.interval = interval;
+                pwrite(fd, &header, sizeof header, 0);
+            }
+
+            offset = (info.st_size + NVSM_RECORD_BLOCK_SIZE - 1) / NVSM_RECORD_BLOCK_SIZE * NVSM_RECORD_BLOCK_SIZE;
+        }
+    }
+
+    std::cout << "Recording to " << path << "\n";
+
+    gpuCount = gpus.size();
+    utilization.resize(gpuCount);
+    memory.resize(gpuCount);
+    clearBlock();
+
+    return true;
+}
+
+// writes the header block of a new recording to the empty file
+bool RecordingWriter::create(const std::vector<GPUSample> &gpus, const uint interval) {
+    std::vector<uint8_t> block(NVSM_RECORD_BLOCK_SIZE, 0);
+
+    RecordingHeader header {};
+    memcpy(header.magic, NVSM_RECORD_MAGIC, sizeof header.magic);
+    header.version = NVSM_RECORD_VERSION;
+    header.gpuCount = gpus.size();
+    header.interval = interval;
+    memcpy(block.data(), &header, sizeof header);
+
+    size_t position = sizeof header;
+    for (const GPUSample &gpu : gpus) {
+        int32_t total = gpu.memoryTotal;
+        memcpy(block.data() + position, &total, sizeof total);
+        position += sizeof total;
+    }
+
+    // names that do not fit are replayed as "GPU <index>", UUIDs only identify the GPUs on append
+    std::vector<const std::string*> strings;
+    for (const GPUSample &gpu : gpus)
+        strings.push_back(&gpu.name);
+    for (const GPUSample &gpu : gpus)
+        strings.push_back(&gpu.uuid);
+
+    for (const std::string *string : strings) {
+        if (position + string->size() + 1 > block.size())
+            break;
+        memcpy(block.data() + position, string->c_str(), string->size() + 1);
+        position += string->size() + 1;
+    }
+
+    if (pwrite(fd, block.data(), block.size(), 0) != (ssize_t) block.size()) {
+        std::cout << "Could not write recording " << path << "\n";
+        close(fd);
+        fd = -1;
+        return false;
+    }
+
+    offset = NVSM_RECORD_BLOCK_SIZE;
+    return true;
+}
+
+// the recording of other GPUs goes to the first free <path>.<n>, fd is then a new empty file at path
+void RecordingWriter::moveAside() {
+    close(fd);
+    fd = -1;
+
+    std::string segment;
+    for (int n = 1; segment.empty() || access(segment.c_str(), F_OK) == 0; n++)
+        segment = path + "." + std::to_string(n);
+
+    if (rename(path.c_str(), segment.c_str()) != 0) {
+        std::cout << path << " is a recording of other GPUs and could not be moved to " << segment << ", not recording\n";
+        return;
+    }
+    std::cout << path << " is a recording of other GPUs, moved it to " << segment << "\n";
+
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if (fd < 0)
+        std::cout << "Could not open recording " << path << "\n";
+}
+
+void RecordingWriter::add(long time, const std::vector<uint8_t> &utilization, const std::vector<int> &memoryUsed) {
+    if (fd < 0)
+        return;
+
+    // open() starts a new segment for other GPUs, samples of them must not go into this one
+    if ((int) utilization.size() != gpuCount || (int) memoryUsed.size() != gpuCount) {
+        std::cout << "The GPUs changed while recording to " << path << ", stopped recording\n";
+        flush();
+        close(fd);
+        fd = -1;
+        return;
+    }
+
+    time = std::max(time, lastTime); // block times must not go back
+
+    // bytes this sample adds to the block
+    auto sampleSize = [&]() {
+        size_t size = count > 0 ? varintSize(time - lastTime) : 0;
+        for (int GPU = 0; GPU < gpuCount; GPU++)
+            size += 1 + varintSize(zigzag(memoryUsed[GPU] - lastMemory[GPU]));
+        return size;
+    };
+
+    size_t size = sampleSize();
+    if (count > 0 && sizeof(BlockHeader) + payload + size > NVSM_RECORD_BLOCK_SIZE) {
+        writeBlock();
+        offset += NVSM_RECORD_BLOCK_SIZE;
+        clearBlock();
+        size = sampleSize();
+    }
+
+    if (count == 0)
+        firstTime = time;
+    else
+        putVarint(times, time - lastTime);
+
+    for (int GPU = 0; GPU < gpuCount; GPU++) {
+        this->utilization[GPU].push_back(utilization[GPU]);
+        putVarint(memory[GPU], zigzag(memoryUsed[GPU] - lastMemory[GPU]));
+        lastMemory[GPU] = memoryUsed[GPU];
+    }
+
+    lastTime = time;
+    payload += size;
+    count++;
+    dirty = true;
+}
+
+void RecordingWriter::flush() {
+    if (fd >= 0 && dirty)
+        writeBlock();
+}
+
+// the block is rewritten in place until it is full
+void RecordingWriter::writeBlock() {
+    std::vector<uint8_t> block(NVSM_RECORD_BLOCK_SIZE, 0);
+
+    BlockHeader header {};
+    header.magic = NVSM_RECORD_BLOCK_MAGIC;
+    header.count = count;
+    header.size = payload;
+    header.time = firstTime;
+    memcpy(block.data(), &header, sizeof header);
+
+    uint8_t *out = block.data() + sizeof header;
+    out = std::copy(times.begin(), times.end(), out);
+    for (int GPU = 0; GPU < gpuCount; GPU++) {
+        out = std::copy(utilization[GPU].begin(), utilization[GPU].end(), out);
+        out = std::copy(memory[GPU].begin(), memory[GPU].end(), out);
+    }
+
+    if (pwrite(fd, block.data(), block.size(), offset) != (ssize_t) block.size())
+        std::cout << "Could not write recording " << path << "\n";
+
+    dirty = false;
+}
+
+void RecordingWriter::clearBlock() {
+    count = 0;
+    payload = 0;
+    times.clear();
+    for (int GPU = 0; GPU < gpuCount; GPU++) {
+        utilization[GPU].clear();
+        memory[GPU].clear();
+    }
+    lastMemory.assign(gpuCount, 0);
+}
+
+Recording::~Recording() {
+    if (data)
+        munmap(const_cast<uint8_t*>(data), size);
+}
+
+bool Recording::open(const std::string &path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        std::cout << "Could not open recording " << path << "\n";
+        return false;
+    }
+
+    struct stat info {};
+    fstat(fd, &info);
+    size = info.st_size;
+
+    if (size >= NVSM_RECORD_BLOCK_SIZE) {
+        void *mapped = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        data = mapped != MAP_FAILED ? static_cast<const uint8_t*>(mapped) : nullptr;
+    }
+    close(fd);
+
+    RecordingHeader header {};
+    if (data)
+        memcpy(&header, data, sizeof header);
+
+    if (!data || !validHeader(header)) {
+        std::cout << path << " is not a recording\n";
+        return false;
+    }
+
+    gpuCount = header.gpuCount;
+    interval = header.interval;
+
+    int GPU = 0;
+    for (const GPUSample &gpu : readGPUs(data, gpuCount)) {
+        memoryTotal.push_back(gpu.memoryTotal);
+        names.push_back(gpu.name.empty() ? "GPU " + std::to_string(GPU) : gpu.name);
+        uuids.push_back(gpu.uuid);
+        GPU++;
+    }
+
+    // blocks that were never written (zero count) are skipped
+    for (size_t blockOffset = NVSM_RECORD_BLOCK_SIZE; blockOffset + NVSM_RECORD_BLOCK_SIZE <= size; blockOffset += NVSM_RECORD_BLOCK_SIZE) {
+        BlockHeader block {};
+        memcpy(&block, data + blockOffset, sizeof block);
+        if (block.magic == NVSM_RECORD_BLOCK_MAGIC && block.count > 0)
+            blocks.push_back({blockOffset, static_cast<long>(block.time)});
+    }
+
+    // a block torn by a crash while it was written is left out, the ones before it still replay
+    while (!blocks.empty() && !decode(blocks.size() - 1))
+        blocks.pop_back();
+
+    if (blocks.empty()) {
+        std::cout << path << " has no samples\n";
+        return false;
+    }
+
+    begin = blocks.front().time;
+    end = sampleTimes.back();
+
+    return true;
+}
+
+void Recording::read(const long from, const long to, const std::function<void(long, const std::vector<GPUSample>&)> &f) {
+    if (blocks.empty() || to <= from)
+        return;
+
+    // the last block starting before from may still have samples after it
+    auto next = std::upper_bound(blocks.begin(), blocks.end(), from, [](long time, const Block &block) {
+        return time < block.time;
+    });
+    size_t block = next == blocks.begin() ? 0 : next - blocks.begin() - 1;
+
+    for (; block < blocks.size() && blocks[block].time <= to; block++) {
+        if (!decode(block))
+            continue;
+
+        for (size_t i = 0; i < sampleTimes.size(); i++) {
+            if (sampleTimes[i] > from && sampleTimes[i] <= to)
+                f(sampleTimes[i], samples[i]);
+        }
+    }
+}
+
+bool Recording::decode(const size_t block) {
+    if (block == decoded)
+        return true;
+
+    decoded = SIZE_MAX;
+    sampleTimes.clear();
+
+    BlockHeader header {};
+    memcpy(&header, data + blocks[block].offset, sizeof header);
+    if (sizeof header + header.size > NVSM_RECORD_BLOCK_SIZE)
+        return false;
+
+    const uint8_t *in = data + blocks[block].offset + sizeof header, *end = in + header.size;
+    uint64_t value;
+
+    long time = header.time;
+    sampleTimes.push_back(time);
+    for (int i = 1; i < header.count; i++) {
+        if (!getVarint(in, end, value))
+            return false;
+        time += value;
+        sampleTimes.push_back(time);
+    }
+
+    samples.resize(header.count);
+    for (std::vector<GPUSample> &sample : samples)
+        sample.resize(gpuCount);
+
+    for (int GPU = 0; GPU < gpuCount; GPU++) {
+        if (end - in < header.count)
+            return false;
+
+        for (int i = 0; i < header.count; i++) {
+            samples[i][GPU].name = names[GPU];
+            samples[i][GPU].utilization = *in++;
+        }
+
+        int used = 0;
+        for (int i = 0; i < header.count; i++) {
+            if (!getVarint(in, end, value))
+                return false;
+            used += unzigzag(value);
+
+            GPUSample &sample = samples[i][GPU];
+            sample.memoryTotal = memoryTotal[GPU];
+            sample.memoryUsed = used;
+            sample.memoryFree = memoryTotal[GPU] - used;
+        }
+    }
+
+    decoded = block;
+
+    return true;
+}
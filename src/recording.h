@@ -0,0 +1,141 @@
+#ifndef RECORDING_H
+#define RECORDING_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+#include "source.h"
+
+/*
+ * Recording file layout, native byte order. The file is a sequence of
+ * NVSM_RECORD_BLOCK_SIZE blocks:
+ *
+ *   block 0    RecordingHeader, memory total of every GPU (int32), GPU names, then UUIDs
+ *              (NUL terminated, the ones that do not fit are left out)
+ *   block 1..  BlockHeader, then the columns of its samples:
+ *                time deltas to the previous sample          count - 1 varints
+ *                for every GPU: utilization in %             count bytes
+ *                               memory used delta in MiB     count zigzag varints
+ *
+ * Every block starts from zero, so it decodes on its own and replay can seek
+ * with a binary search over the block times. A block holds a few hundred
+ * samples, which is a few bytes per GPU per sample
+ */
+
+struct RecordingHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t gpuCount;
+    uint32_t interval; // ms between samples
+    uint32_t reserved;
+};
+
+struct BlockHeader {
+    uint32_t magic;
+    uint16_t count; // samples, 0 - block was never written
+    uint16_t size; // bytes of columns after the header
+    int64_t time; // of the first sample, ms since epoch
+};
+
+// varints of the columns, 7 bits per byte, least significant first
+void putVarint(std::vector<uint8_t> &out, uint64_t value);
+bool getVarint(const uint8_t *&in, const uint8_t *end, uint64_t &value); // false if it runs past end
+
+// maps signed to unsigned, so small negative deltas stay small varints
+uint64_t zigzag(int64_t value);
+int64_t unzigzag(uint64_t value);
+
+// same count, names and UUIDs; an empty name or UUID, one that was not known, matches any
+bool sameGPUs(const std::vector<GPUSample> &a, const std::vector<GPUSample> &b);
+
+/**
+ * Encodes samples into a recording file. The block being filled is kept in
+ * memory and rewritten in place by flush(), see Recorder for the thread.
+ * A recording holds one set of GPUs; when they change, the old one is moved
+ * to the next free <path>.<n> and a new segment starts at path
+ */
+class RecordingWriter {
+public:
+    explicit RecordingWriter(const std::string &path);
+    ~RecordingWriter();
+
+    // creates the file, or appends to it if it is a recording of the same GPUs, interval in ms;
+    // called again, it flushes and starts a new segment if the GPUs changed
+    bool open(const std::vector<GPUSample> &gpus, uint interval);
+    bool isOpen() const { return fd >= 0; }
+
+    // utilization in %, memoryUsed in MiB, one per GPU; the writer stops if the count is not the one opened
+    void add(long time, const std::vector<uint8_t> &utilization, const std::vector<int> &memoryUsed);
+
+    // writes the block being filled if it changed
+    void flush();
+
+private:
+    std::string path;
+    int fd = -1;
+    int gpuCount = 0;
+    off_t offset = 0; // of the block being filled
+
+    // block being filled
+    uint16_t count = 0;
+    long firstTime = 0, lastTime = 0;
+    std::vector<uint8_t> times;
+    std::vector<std::vector<uint8_t>> utilization, memory;
+    std::vector<int> lastMemory;
+    size_t payload = 0;
+    bool dirty = false; // block changed since it was written
+
+    void writeBlock();
+    void clearBlock();
+    bool create(const std::vector<GPUSample> &gpus, uint interval);
+    void moveAside();
+};
+
+/**
+ * Read-only view of a recording, memory-mapped, blocks are decoded on demand
+ */
+class Recording {
+public:
+    ~Recording();
+
+    bool open(const std::string &path);
+
+    int getGPUCount() const { return gpuCount; }
+    uint getInterval() const { return interval; }
+    const std::vector<std::string>& getNames() const { return names; }
+    const std::vector<std::string>& getUUIDs() const { return uuids; } // empty strings if unknown
+
+    // time of the first and the last sample
+    long getBegin() const { return begin; }
+    long getEnd() const { return end; }
+
+    // calls f for every sample with from < time <= to, oldest first
+    void read(long from, long to, const std::function<void(long time, const std::vector<GPUSample> &gpus)> &f);
+
+private:
+    const uint8_t *data = nullptr;
+    size_t size = 0;
+
+    int gpuCount = 0;
+    uint interval = 0;
+    std::vector<std::string> names, uuids;
+    std::vector<int> memoryTotal;
+    struct Block {
+        size_t offset;
+        long time; // of the first sample
+    };
+    std::vector<Block> blocks;
+    long begin = 0, end = 0;
+
+    // the last decoded block, consecutive reads mostly hit it
+    size_t decoded = SIZE_MAX;
+    std::vector<long> sampleTimes;
+    std::vector<std::vector<GPUSample>> samples;
+
+    bool decode(size_t block);
+};
+
+#endif
@@ -0,0 +1,82 @@
+#include "replay.h"
+
+#include <algorithm>
+
+#include "constants.h"
+#include "settings.h"
+#include "utils.h"
+
+Replay::Replay(Recording *recording, UtilizationWorker *gpuUtilization, UtilizationWorker *memoryUtilization)
+    : recording(recording), workers {gpuUtilization, memoryUtilization}
+{
+    position = recording->getBegin();
+    lastTick = getTime();
+
+    connect(&timer, &QTimer::timeout, this, &Replay::tick);
+    timer.start(NVSM_REPLAY_TICK);
+
+    feed();
+}
+
+void Replay::seek(const long time) {
+    position = std::clamp(time, getBegin(), getEnd());
+    feed();
+}
+
+void Replay::setSpeed(const double speed) {
+    this->speed = speed;
+}
+
+void Replay::setPaused(const bool paused) {
+    if (this->paused == paused)
+        return;
+
+    // playing from the end starts over
+    if (!paused && position == getEnd())
+        position = getBegin();
+
+    this->paused = paused;
+    lastTick = getTime();
+    pausedChanged(paused);
+}
+
+void Replay::tick() {
+    long now = getTime();
+
+    if (!paused) {
+        position = std::min(position + static_cast<long>((now - lastTick) * speed), getEnd());
+        if (position == getEnd())
+            setPaused(true);
+    }
+
+    lastTick = now;
+
+    if (position != shown)
+        feed();
+}
+
+void Replay::feed() {
+    // the graphs can not continue from a position behind or far before the new one
+    bool restart = position < shown || position - shown > GRAPH_LENGTH;
+    long from = restart ? position - GRAPH_LENGTH - 2 * (long) recording->getInterval() : shown;
+
+    for (UtilizationWorker *worker : workers) {
+        worker->mutex.lock();
+        if (restart)
+            worker->clear();
+    }
+
+    recording->read(from, position, [this](long time, const std::vector<GPUSample> &gpus) {
+        for (UtilizationWorker *worker : workers)
+            worker->addSample(time, gpus);
+    });
+
+    for (UtilizationWorker *worker : workers) {
+        worker->publish();
+        worker->mutex.unlock();
+        worker->dataUpdated();
+    }
+
+    shown = position;
+    positionChanged(position);
+}
@@ -0,0 +1,69 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <QObject>
+#include <QTimer>
+#include <climits>
+
+#include "recording.h"
+#include "utilization.h"
+
+/**
+ * Source of the collector while a recording is replayed. It has no live
+ * data, Replay feeds the recorded samples to the workers itself
+ */
+class ReplaySource : public MetricsSource {
+public:
+    Recording recording;
+
+    const char* getName() const override { return "recording"; }
+
+    bool sampleGPUs(std::vector<GPUSample>&) override { return false; }
+
+    bool sampleProcesses(std::vector<ProcessSample> &processes) override {
+        processes.clear(); // processes are not recorded
+        return true;
+    }
+};
+
+/**
+ * Plays a recording into the utilization workers at any speed and from any
+ * position. Every tick adds the samples between the previous and the new
+ * position, after a seek the whole graph window is read again
+ */
+class Replay : public QObject {
+    Q_OBJECT
+public:
+    Replay(Recording *recording, UtilizationWorker *gpuUtilization, UtilizationWorker *memoryUtilization);
+
+    long getBegin() const { return recording->getBegin(); }
+    long getEnd() const { return recording->getEnd(); }
+    long getPosition() const { return position; }
+
+public slots:
+    void seek(long time);
+    void setSpeed(double speed);
+    void setPaused(bool paused);
+
+signals:
+    void positionChanged(long position);
+    void pausedChanged(bool paused);
+
+private slots:
+    void tick();
+
+private:
+    Recording *recording;
+    UtilizationWorker *workers[2];
+    QTimer timer;
+
+    long position;
+    long shown = LONG_MAX; // position the graphs show, LONG_MAX - nothing
+    long lastTick;
+    double speed = 1;
+    bool paused = false;
+
+    void feed();
+};
+
+#endif
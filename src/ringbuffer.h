@@ -0,0 +1,76 @@
+#ifndef RINGBUFFER_H
+#define RINGBUFFER_H
+
+#include <vector>
+#include <cstddef>
+
+/**
+ * Fixed capacity FIFO: storage is allocated once, push_back and pop_front
+ * are O(1). When full, push_back overwrites the oldest element
+ */
+template<typename T>
+class RingBuffer {
+public:
+    RingBuffer() = default;
+
+    explicit RingBuffer(size_t capacity) {
+        setCapacity(capacity);
+    }
+
+    // drops all elements
+    void setCapacity(size_t capacity) {
+        data.assign(capacity > 0 ? capacity : 1, T());
+        head = count = 0;
+    }
+
+    size_t capacity() const { return data.size(); }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    bool full() const { return count == data.size(); }
+
+    // 0 is the oldest element
+    T& operator[](size_t i) { return data[wrap(head + i)]; }
+    const T& operator[](size_t i) const { return data[wrap(head + i)]; }
+
+    T& front() { return data[head]; }
+    const T& front() const { return data[head]; }
+    T& back() { return (*this)[count - 1]; }
+    const T& back() const { return (*this)[count - 1]; }
+
+    // a default constructed buffer has no storage until setCapacity(), it keeps nothing
+    void push_back(const T &value) {
+        if (data.empty())
+            return;
+
+        if (full()) {
+            data[head] = value;
+            head = wrap(head + 1);
+        } else {
+            data[wrap(head + count)] = value;
+            count++;
+        }
+    }
+
+    void pop_front() {
+        head = wrap(head + 1);
+        count--;
+    }
+
+    void pop_back() {
+        count--;
+    }
+
+    void clear() {
+        head = count = 0;
+    }
+
+private:
+    std::vector<T> data;
+    size_t head = 0, count = 0;
+
+    size_t wrap(size_t i) const {
+        return i >= data.size() ? i - data.size() : i;
+    }
+};
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef ROWDIFF_H
+#define ROWDIFF_H
+
+#include <algorithm>
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Brings rows to the rows of a new snapshot, matched by Row::key(). Rows that
+ * are gone are removed, rows still there are updated in place and new ones are
+ * appended in snapshot order, so a row never moves while its process lives.
+ * rows is changed between the begin and end calls, as item models need it:
+ *
+ *   listener.beginRemove(first, last), listener.endRemove(first, last)
+ *   listener.kept(row, from, changed) - row now holds incoming[from]
+ *   listener.beginInsert(first, last), listener.inserted(row, from), listener.endInsert()
+ *
+ * Adjacent removed rows are removed in one go, from the end, so the rows
+ * before them keep their indexes. Returns true if rows were removed or added
+ */
+template<typename Row, typename Listener>
+bool diffRows(std::vector<Row> &rows, const std::vector<Row> &incoming, Listener &listener) {
+    using Key = decltype(incoming.front().key());
+
+    std::unordered_map<Key, size_t> remaining; // key -> index in incoming
+    remaining.reserve(incoming.size());
+    for (size_t i = 0; i < incoming.size(); i++)
+        remaining.emplace(incoming[i].key(), i);
+
+    bool moved = false;
+    for (size_t end = rows.size(); end > 0; end--) {
+        if (remaining.count(rows[end - 1].key()))
+            continue;
+
+        size_t last = end - 1, first = last;
+        while (first > 0 && !remaining.count(rows[first - 1].key()))
+            first--;
+
+        listener.beginRemove(first, last);
+        rows.erase(rows.begin() + first, rows.begin() + last + 1);
+        listener.endRemove(first, last);
+
+        end = first + 1;
+        moved = true;
+    }
+
+    for (size_t row = 0; row < rows.size(); row++) {
+        auto it = remaining.find(rows[row].key());
+        const Row &next = incoming[it->second];
+
+        bool changed = rows[row] != next;
+        if (changed)
+            rows[row] = next;
+        listener.kept(row, it->second, changed);
+
+        remaining.erase(it);
+    }
+
+    if (remaining.empty())
+        return moved;
+
+    std::vector<size_t> added;
+    added.reserve(remaining.size());
+    for (const auto &entry : remaining)
+        added.push_back(entry.second);
+    std::sort(added.begin(), added.end());
+
+    listener.beginInsert(rows.size(), rows.size() + added.size() - 1);
+    for (size_t from : added) {
+        rows.push_back(incoming[from]);
+        listener.inserted(rows.size() - 1, from);
+    }
+    listener.endInsert();
+
+    return true;
+}
+
+#endif
@@ -0,0 +1,16 @@
+#include "sampler.h"
+
+// the source may take long, readers keep using the previous snapshot meanwhile
+void GPUSampler::sample() {
+    bool sampled = source->sampleGPUs(gpus);
+    stale = !sampled;
+
+    if (sampled) {
+        metadata.update(gpus);
+        snapshot.store(std::make_shared<const std::vector<GPUSample>>(gpus));
+    }
+}
+
+std::shared_ptr<const std::vector<GPUSample>> GPUSampler::getSnapshot() const {
+    return snapshot.load();
+}
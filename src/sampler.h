@@ -0,0 +1,32 @@
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include <atomic>
+#include <memory>
+
+#include "source.h"
+#include "snapshot.h"
+#include "topology.h"
+
+/**
+ * Samples all GPUs once per tick and keeps the result, so every worker
+ * reads the same snapshot instead of querying the source on its own
+ */
+class GPUSampler {
+public:
+    MetricsSource *source = nullptr;
+    std::vector<GPUSample> gpus; // written only by sample(), read it from the same task
+    std::atomic<bool> stale {false}; // the last sample failed, gpus holds older values
+
+    void sample();
+
+    // for workers running in other tasks and other threads, never blocks
+    std::shared_ptr<const std::vector<GPUSample>> getSnapshot() const;
+    std::shared_ptr<const GPUTopology> getTopology() const { return metadata.get(); }
+
+private:
+    Snapshot<std::vector<GPUSample>> snapshot;
+    GPUMetadataCache metadata;
+};
+
+#endif
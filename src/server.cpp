@@ -0,0 +1,324 @@
+#include "server.h"
+
+#include <iostream>
+#include <sstream>
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "constants.h"
+#include "metrics.h"
+#include "settings.h"
+
+#define BUFFER_SIZE 4096
+
+SocketServer::SocketServer(Collector *collector): collector(collector) {}
+
+SocketServer::~SocketServer() {
+    stop();
+
+    for (Client &client : clients)
+        close(client.fd);
+
+    if (fd >= 0)
+        close(fd);
+}
+
+void SocketServer::stop() {
+    running = false;
+    wait();
+}
+
+void SocketServer::run() {
+    std::vector<pollfd> fds;
+
+    while (running) {
+        fds.clear();
+        fds.push_back({fd, POLLIN, 0});
+        for (const Client &client : clients)
+            fds.push_back({client.fd, (short) (client.out.empty() ? POLLIN : POLLIN | POLLOUT), 0});
+
+        // the timeout only bounds how long stop() waits
+        if (poll(fds.data(), fds.size(), NVSM_SERVER_POLL_TIMEOUT) < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+
+        for (size_t i = clients.size(); i-- > 0;) {
+            short events = fds[i + 1].revents;
+            bool alive = true;
+
+            if (events & (POLLIN | POLLHUP | POLLERR))
+                alive = receive(clients[i]);
+            if (alive && (events & POLLOUT))
+                alive = send(clients[i]);
+
+            if (!alive) {
+                close(clients[i].fd);
+                clients.erase(clients.begin() + i);
+            }
+        }
+
+        if (fds[0].revents & POLLIN) {
+            int client;
+            while ((client = accept4(fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0)
+                clients.push_back({client, "", ""});
+        }
+    }
+}
+
+bool SocketServer::receive(Client &client) {
+    char chunk[BUFFER_SIZE];
+    ssize_t count;
+
+    while ((count = read(client.fd, chunk, sizeof chunk)) != 0) {
+        if (count < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                return false;
+            break;
+        }
+
+        client.in.append(chunk, count);
+    }
+
+    if (count == 0)
+        return false; // client closed the connection
+
+    if (!handle(client))
+        return false;
+
+    // a request can not be that long
+    if (client.in.size() > BUFFER_SIZE)
+        return false;
+
+    return client.out.empty() || send(client);
+}
+
+bool SocketServer::send(Client &client) {
+    ssize_t count = ::send(client.fd, client.out.data(), client.out.size(), MSG_NOSIGNAL);
+
+    if (count < 0)
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+
+    client.out.erase(0, count);
+
+    return !(client.out.empty() && client.closeWhenSent);
+}
+
+SnapshotServer::SnapshotServer(Collector *collector, const std::string &path): SocketServer(collector), path(path) {}
+
+SnapshotServer::~SnapshotServer() {
+    stop();
+
+    if (fd >= 0)
+        unlink(path.c_str());
+}
+
+bool SnapshotServer::listen() {
+    sockaddr_un address {};
+    address.sun_family = AF_UNIX;
+
+    if (path.size() >= sizeof address.sun_path) {
+        std::cout << "Socket path is too long: " << path << "\n";
+        return false;
+    }
+
+    path.copy(address.sun_path, path.size());
+
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        std::cout << "socket() failed\n";
+        return false;
+    }
+
+    // a socket nobody accepts on was left by a collector that was killed, a running one keeps it
+    int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (probe >= 0) {
+        int error = ::connect(probe, (sockaddr*) &address, sizeof address) == 0 ? 0 : errno;
+        close(probe);
+
+        if (error == ECONNREFUSED) {
+            unlink(path.c_str());
+        } else if (error != ENOENT) {
+            std::cout << "Not taking over " << path << ": "
+                      << (error == 0 ? "another collector is listening on it" : strerror(error)) << "\n";
+            close(fd);
+            fd = -1;
+            return false;
+        }
+    }
+
+    if (bind(fd, (sockaddr*) &address, sizeof address) != 0 || ::listen(fd, NVSM_SERVER_BACKLOG) != 0) {
+        std::cout << "Could not listen on " << path << "\n";
+        close(fd);
+        fd = -1;
+        return false;
+    }
+
+    std::cout << "Listening on " << path << "\n";
+
+    return true;
+}
+
+bool SnapshotServer::handle(Client &client) {
+    size_t begin = 0, end;
+    while ((end = client.in.find('\n', begin)) != std::string::npos) {
+        handleCommand(client.in.substr(begin, end - begin), client.out);
+        begin = end + 1;
+    }
+    client.in.erase(0, begin);
+
+    return true;
+}
+
+#define _field(value) << '\t' << (value)
+
+void SnapshotServer::handleCommand(const std::string &command, std::string &out) {
+    std::istringstream in(command);
+    std::ostringstream response;
+    std::string name;
+    in >> name;
+
+    if (name == NVSM_PROTO_GPUS) {
+        std::shared_ptr<const std::vector<GPUSample>> snapshot = collector->workerThread->sampler.getSnapshot();
+        const std::vector<GPUSample> &gpus = *snapshot;
+
+        for (size_t i = 0; i < gpus.size(); i++) {
+            response << NVSM_PROTO_GPU _field(i) _field(gpus[i].name)
+                     _field(gpus[i].utilization) _field(gpus[i].memoryUtilization)
+                     _field(gpus[i].memoryTotal) _field(gpus[i].memoryFree) _field(gpus[i].memoryUsed)
+                     _field(gpus[i].uuid) << '\n';
+        }
+    } else if (name == NVSM_PROTO_PROCESSES) {
+        std::shared_ptr<const ProcessesData> data = collector->processes->data.load();
+
+        response << NVSM_PROTO_SAMPLE _field(data->time) << '\n';
+        for (const ProcessSample &p : data->samples) {
+            response << NVSM_PROTO_PROCESS _field(p.GPUIndex) _field(p.pid) _field(p.type) _field(p.name)
+                     _field(p.sm) _field(p.mem) _field(p.enc) _field(p.dec) _field(p.fb) << '\n';
+        }
+    } else if (name == NVSM_PROTO_HISTORY) {
+        std::string type;
+        int index = -1;
+        in >> type >> index;
+
+        UtilizationWorker *worker = nullptr;
+        if (type == NVSM_PROTO_HISTORY_GPU)
+            worker = collector->gpuUtilization;
+        else if (type == NVSM_PROTO_HISTORY_MEMORY)
+            worker = collector->memoryUtilization;
+
+        // the GPUs may change at any sample, the index is checked against the view it reads
+        std::shared_ptr<const UtilizationView> view = worker ? worker->view.load() : nullptr;
+        if (!view || index < 0 || index >= (int) view->graphPoints.size()) {
+            response << NVSM_PROTO_ERROR "\tusage: history <gpu|memory> <index>\n";
+        } else {
+            const RingBuffer<Point> &points = view->graphPoints[index];
+
+            for (size_t i = 0; i < points.size(); i++)
+                response << NVSM_PROTO_POINT _field(points[i].time) _field(points[i].y) << '\n';
+        }
+    } else {
+        response << NVSM_PROTO_ERROR "\tunknown command\n";
+    }
+
+    response << NVSM_PROTO_END "\n";
+    out += response.str();
+}
+
+MetricsServer::MetricsServer(Collector *collector): SocketServer(collector) {}
+
+MetricsServer::~MetricsServer() {
+    stop();
+}
+
+bool MetricsServer::listen(const int port) {
+    sockaddr_in address {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+
+    fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        std::cout << "socket() failed\n";
+        return false;
+    }
+
+    int reuse = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof reuse);
+
+    if (bind(fd, (sockaddr*) &address, sizeof address) != 0 || ::listen(fd, NVSM_SERVER_BACKLOG) != 0) {
+        std::cout << "Could not listen on port " << port << "\n";
+        close(fd);
+        fd = -1;
+        return false;
+    }
+
+    std::cout << "Serving metrics on port " << port << "\n";
+
+    return true;
+}
+
+// one request per connection, which is how Prometheus scrapes anyway
+bool MetricsServer::handle(Client &client) {
+    if (client.closeWhenSent || client.in.find("\r\n\r\n") == std::string::npos)
+        return true;
+
+    std::istringstream request(client.in);
+    std::string method, target;
+    request >> method >> target;
+    client.in.clear();
+
+    std::string status = "200 OK", body;
+    if (method != "GET") {
+        status = "405 Method Not Allowed";
+    } else if (target != NVSM_METRICS_PATH) {
+        status = "404 Not Found";
+    } else {
+        body = render();
+    }
+
+    client.out += "HTTP/1.1 " + status + "\r\n"
+                  "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                  "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                  "Connection: close\r\n\r\n" + body;
+    client.closeWhenSent = true;
+
+    return true;
+}
+
+std::string MetricsServer::render() {
+    // the memory worker may follow a change of the GPUs a sample later
+    std::vector<GPUMetrics> gpus;
+
+    std::shared_ptr<const UtilizationView> utilization = collector->gpuUtilization->view.load();
+    gpus.resize(utilization->utilizationData.size());
+    for (size_t i = 0; i < utilization->utilizationData.size(); i++) {
+        gpus[i].name = utilization->utilizationData[i].name;
+        gpus[i].utilization = utilization->utilizationData[i].level;
+    }
+
+    std::shared_ptr<const UtilizationView> memoryUtilization = collector->memoryUtilization->view.load();
+    const std::vector<MemoryData> &memory = memoryUtilization->memoryData;
+    if (memory.size() > gpus.size())
+        gpus.resize(memory.size());
+    for (size_t i = 0; i < memory.size(); i++) {
+        if (gpus[i].name.empty() && i < memoryUtilization->utilizationData.size())
+            gpus[i].name = memoryUtilization->utilizationData[i].name;
+        gpus[i].memoryUsed = memory[i].used;
+        gpus[i].memoryFree = memory[i].free;
+        gpus[i].memoryTotal = memory[i].total;
+    }
+
+    std::shared_ptr<const ProcessesData> data = collector->processes->data.load();
+
+    return renderMetrics(gpus, data->samples);
+}
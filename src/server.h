@@ -0,0 +1,92 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <QThread>
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "collector.h"
+
+/**
+ * Non-blocking poll() loop serving any number of clients of one listening
+ * socket on its own thread. Subclasses only parse requests and build responses
+ */
+class SocketServer : public QThread {
+public:
+    ~SocketServer() override;
+
+    void stop();
+
+    void run() override;
+
+protected:
+    struct Client {
+        int fd;
+        std::string in, out;
+        bool closeWhenSent = false;
+    };
+
+    Collector *collector;
+    int fd = -1;
+
+    explicit SocketServer(Collector *collector);
+
+    // consumes complete requests from client.in and appends the responses to client.out,
+    // returns false to drop the client
+    virtual bool handle(Client &client) = 0;
+
+private:
+    std::atomic<bool> running {true};
+    std::vector<Client> clients;
+
+    bool receive(Client &client);
+    bool send(Client &client);
+};
+
+/**
+ * Serves the latest collected data over a Unix domain socket, so several
+ * clients can share one collector. Line protocol, one command per line:
+ *
+ *   gpus                     ->  gpu <index> <name> <utilization> <memory utilization> <total> <free> <used>
+ *   processes                ->  process <gpu> <pid> <type> <name> <sm> <mem> <enc> <dec> <fb>
+ *   history <gpu|memory> <n> ->  point <time in ms> <value in %>
+ *
+ * Fields are separated by tabs, values that are not available are -1,
+ * and every response ends with an "end" line
+ */
+class SnapshotServer : public SocketServer {
+public:
+    SnapshotServer(Collector *collector, const std::string &path);
+    ~SnapshotServer() override;
+
+    bool listen();
+
+protected:
+    bool handle(Client &client) override;
+
+private:
+    std::string path;
+
+    void handleCommand(const std::string &command, std::string &out);
+};
+
+/**
+ * Prometheus / OpenMetrics endpoint: GET /metrics returns what the workers
+ * have already collected, a scrape never triggers a new collection
+ */
+class MetricsServer : public SocketServer {
+public:
+    explicit MetricsServer(Collector *collector);
+    ~MetricsServer() override;
+
+    bool listen(int port);
+
+protected:
+    bool handle(Client &client) override;
+
+private:
+    std::string render();
+};
+
+#endif
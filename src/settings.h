@@ -2,17 +2,32 @@
 #define SETTINGS_H
 
 #include "constants.h"
-#include <QColor>
+#include <string>
+#include <vector>
 
 extern uint UPDATE_DELAY;
 extern uint GRAPH_LENGTH;
-extern int GPU_COUNT;
+extern uint PROCESSES_DELAY; // 0 - same as UPDATE_DELAY
+extern int GPU_COUNT; // found at start, the workers follow the GPUs that appear or vanish later
+extern bool STREAMING;
+extern std::string METRICS_SOURCE;
+extern std::string NVML_LIBRARY;
+extern uint METRICS_PORT; // 0 - no metrics endpoint
+extern std::string RECORD_PATH; // empty - not recording
+extern std::vector<std::string> ALERT_RULES; // alert lines of the config, parsed by AlertEngine
+extern std::vector<std::string> FLEET_HOSTS; // empty - no fleet tab
+extern std::string FLEET_COMMAND; // prints the --query-gpu csv of {host}
+extern uint FLEET_DELAY;
+extern uint FLEET_TIMEOUT; // a poll running longer is killed
+extern uint BACKGROUND_DELAY; // sampling interval of sources whose widgets are hidden, 0 - paused
+extern std::string PROC_ROOT; // where procfs is mounted, for user, cmdline, cgroup, CPU and RSS of processes
 
-#define UPDATE_DELAY_USEC (UPDATE_DELAY * 1000)
-#define GRAPH_STEP ((float)UPDATE_DELAY / (float)GRAPH_LENGTH)
-
-#define _c(r, g, b) QColor(r, g, b)
-
-extern QColor gpuColors[8];
+#define PROCESSES_INTERVAL (PROCESSES_DELAY > 0 ? PROCESSES_DELAY : UPDATE_DELAY)
+// interval of a hidden source, never faster than its visible one
+#define BACKGROUND_INTERVAL(interval) (BACKGROUND_DELAY == 0 ? 0 : BACKGROUND_DELAY > (interval) ? BACKGROUND_DELAY : (interval))
+// raw points kept per GPU: the whole graph plus one point beyond its left edge,
+// long graphs are drawn from the coarser history tiers instead
+#define GRAPH_POINTS (GRAPH_LENGTH / (UPDATE_DELAY > 0 ? UPDATE_DELAY : 1) + 2)
+#define GRAPH_CAPACITY (GRAPH_POINTS < NVSM_HISTORY_RAW_POINTS ? GRAPH_POINTS : NVSM_HISTORY_RAW_POINTS)
 
 #endif
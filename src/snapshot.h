@@ -0,0 +1,30 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <atomic>
+#include <memory>
+
+/**
+ * Latest value published by a writer for any number of readers. The writer
+ * builds a new value without holding any lock and swaps the pointer in,
+ * readers share the immutable value they loaded, so a reader never waits for
+ * a collection and a slow reader never delays the writer
+ */
+template<typename T>
+class Snapshot {
+public:
+    Snapshot(): value(std::make_shared<const T>()) {}
+
+    std::shared_ptr<const T> load() const {
+        return std::atomic_load_explicit(&value, std::memory_order_acquire);
+    }
+
+    void store(std::shared_ptr<const T> next) {
+        std::atomic_store_explicit(&value, std::move(next), std::memory_order_release);
+    }
+
+private:
+    std::shared_ptr<const T> value;
+};
+
+#endif
@@ -0,0 +1,180 @@
+#include "socketsource.h"
+
+#include <iostream>
+#include <cerrno>
+#include <charconv>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "constants.h"
+#include "parser.h"
+#include "utils.h"
+
+#define BUFFER_SIZE 4096
+
+SocketSource::SocketSource(const std::string &path): path(path) {}
+
+SocketSource::~SocketSource() {
+    disconnect();
+}
+
+bool SocketSource::connect() {
+    sockaddr_un address {};
+    address.sun_family = AF_UNIX;
+
+    if (path.size() >= sizeof address.sun_path)
+        return false;
+
+    path.copy(address.sun_path, path.size());
+
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return false;
+
+    if (::connect(fd, (sockaddr*) &address, sizeof address) != 0) {
+        disconnect();
+        return false;
+    }
+
+    return true;
+}
+
+void SocketSource::disconnect() {
+    if (fd >= 0)
+        close(fd);
+    fd = -1;
+    buffer.clear();
+}
+
+bool SocketSource::request(const char *command, const std::function<void(std::string_view line)> &onLine) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (fd < 0 && !connect())
+        return false;
+
+    std::string line = std::string(command) + "\n";
+    if (send(fd, line.data(), line.size(), MSG_NOSIGNAL) != (ssize_t) line.size()) {
+        disconnect();
+        return false;
+    }
+
+    long deadline = getTime() + NVSM_CLIENT_TIMEOUT;
+    char chunk[BUFFER_SIZE];
+
+    while (true) {
+        size_t begin = 0, end;
+        while ((end = buffer.find('\n', begin)) != std::string::npos) {
+            std::string_view response = std::string_view(buffer).substr(begin, end - begin);
+            begin = end + 1;
+
+            if (response == NVSM_PROTO_END) {
+                buffer.erase(0, begin);
+                return true;
+            }
+
+            onLine(response);
+        }
+        buffer.erase(0, begin);
+
+        pollfd pfd {fd, POLLIN, 0};
+        long timeout = deadline - getTime();
+        ssize_t count;
+
+        if (timeout <= 0 || poll(&pfd, 1, timeout) <= 0 || (count = read(fd, chunk, sizeof chunk)) <= 0) {
+            // a late response would be mistaken for the next one, so start over
+            std::cout << "Collector at " << path << " did not respond\n";
+            disconnect();
+            return false;
+        }
+
+        buffer.append(chunk, count);
+    }
+}
+
+bool SocketSource::sampleGPUs(std::vector<GPUSample> &gpus) {
+    size_t count = 0;
+
+    bool result = request(NVSM_PROTO_GPUS, [&](std::string_view line) {
+        std::string_view field[NVSMI_QUERY_COLUMNS + 1];
+        for (std::string_view &f : field)
+            if (!nextField(line, f, '\t'))
+                return;
+
+        if (field[0] != NVSM_PROTO_GPU)
+            return;
+
+        // same columns as the nvidia-smi query, after the tag
+        int index = parseInt(field[1 + NVSMI_QUERY_INDEX]);
+        if (index < 0 || index >= NVSM_GPUS_MAX)
+            return;
+
+        if ((size_t) index >= gpus.size())
+            gpus.resize(index + 1);
+
+        GPUSample &gpu = gpus[index];
+        gpu.name.assign(field[1 + NVSMI_QUERY_NAME].data(), field[1 + NVSMI_QUERY_NAME].size());
+        gpu.utilization = parseInt(field[1 + NVSMI_QUERY_GPU], 0);
+        gpu.memoryUtilization = parseInt(field[1 + NVSMI_QUERY_MEM], 0);
+        gpu.memoryTotal = parseInt(field[1 + NVSMI_QUERY_TOTAL], 0);
+        gpu.memoryFree = parseInt(field[1 + NVSMI_QUERY_FREE], 0);
+        gpu.memoryUsed = parseInt(field[1 + NVSMI_QUERY_USED], 0);
+
+        // collectors before the uuid column send none
+        std::string_view uuid;
+        if (nextField(line, uuid, '\t'))
+            gpu.uuid.assign(uuid.data(), uuid.size());
+        else
+            gpu.uuid.clear();
+
+        count++;
+    });
+
+    if (result)
+        gpus.resize(count);
+
+    return result;
+}
+
+bool SocketSource::sampleProcesses(std::vector<ProcessSample> &processes) {
+    std::vector<ProcessSample> received;
+    long time = -1; // collectors before NVSM_PROTO_SAMPLE do not send it, 0 - it has no sample yet
+
+    bool result = request(NVSM_PROTO_PROCESSES, [&](std::string_view line) {
+        std::string_view sample = line, name, value;
+        if (nextField(sample, name, '\t') && name == NVSM_PROTO_SAMPLE && nextField(sample, value, '\t')) {
+            std::from_chars(value.data(), value.data() + value.size(), time);
+            return;
+        }
+
+        std::string_view field[10];
+        for (std::string_view &f : field)
+            if (!nextField(line, f, '\t'))
+                return;
+
+        if (field[0] != NVSM_PROTO_PROCESS)
+            return;
+
+        ProcessSample process;
+        process.GPUIndex = parseInt(field[1], 0);
+        process.pid = parseInt(field[2]);
+        process.type = std::string(field[3]);
+        process.name = std::string(field[4]);
+        process.sm = parseInt(field[5]);
+        process.mem = parseInt(field[6]);
+        process.enc = parseInt(field[7]);
+        process.dec = parseInt(field[8]);
+        process.fb = parseInt(field[9]);
+        received.push_back(process);
+    });
+
+    // the collector has not sampled since the last call, the same sample again would count twice in the history
+    if (!result || time == 0 || (time > 0 && time == processesTime))
+        return false;
+
+    processesTime = time;
+    processes.swap(received);
+
+    return true;
+}
@@ -0,0 +1,38 @@
+#ifndef SOCKETSOURCE_H
+#define SOCKETSOURCE_H
+
+#include <mutex>
+#include <string_view>
+#include <functional>
+
+#include "source.h"
+
+/**
+ * Reads data from a collector started with --headless instead of
+ * querying the GPUs directly, see SnapshotServer for the protocol
+ */
+class SocketSource : public MetricsSource {
+public:
+    explicit SocketSource(const std::string &path);
+    ~SocketSource() override;
+
+    const char* getName() const override { return "collector"; }
+
+    bool sampleGPUs(std::vector<GPUSample> &gpus) override;
+    bool sampleProcesses(std::vector<ProcessSample> &processes) override;
+
+private:
+    std::string path;
+    int fd = -1;
+    std::string buffer;
+    std::mutex mutex; // GPU and process tasks share the connection
+    long processesTime = 0; // of the last process sample taken, see NVSM_PROTO_SAMPLE
+
+    bool connect();
+    void disconnect();
+
+    // sends command and calls onLine for every line of the response
+    bool request(const char *command, const std::function<void(std::string_view line)> &onLine);
+};
+
+#endif
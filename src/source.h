@@ -0,0 +1,45 @@
+#ifndef SOURCE_H
+#define SOURCE_H
+
+#include <string>
+#include <vector>
+
+struct GPUSample {
+    std::string uuid; // empty if the source does not report it
+    std::string name;
+    int utilization = 0, memoryUtilization = 0;
+    int memoryTotal = 0, memoryFree = 0, memoryUsed = 0; // MiB
+};
+
+#define NVSM_NA (-1) // value is not reported by the source
+
+struct ProcessSample {
+    int GPUIndex = 0, pid = 0;
+    std::string type; // C, G or C+G
+    std::string name;
+    int sm = NVSM_NA, mem = NVSM_NA, enc = NVSM_NA, dec = NVSM_NA; // %
+    int fb = NVSM_NA; // MiB
+};
+
+/**
+ * Where the workers take their data from
+ */
+class MetricsSource {
+public:
+    virtual ~MetricsSource() = default;
+
+    virtual const char* getName() const = 0;
+
+    // updates gpus with the latest values, returns false if nothing could be read
+    virtual bool sampleGPUs(std::vector<GPUSample> &gpus) = 0;
+
+    // returns true if processes was replaced by a new complete sample
+    virtual bool sampleProcesses(std::vector<ProcessSample> &processes) = 0;
+
+    // the GPUs / processes are sampled every interval ms from now on, 0 - not until it changes
+    // again; each is called from the task that samples them, streaming sources restart or stop
+    virtual void setGPUInterval(uint /*interval*/) {}
+    virtual void setProcessesInterval(uint /*interval*/) {}
+};
+
+#endif
@@ -0,0 +1,85 @@
+#include "statistics.h"
+
+#include <cmath>
+
+static int clamp(const int value) {
+    return value < 0 ? 0 : value > STATISTICS_MAX_VALUE ? STATISTICS_MAX_VALUE : value;
+}
+
+void WindowStatistics::setCapacity(const size_t capacity) {
+    minimums.setCapacity(capacity);
+    maximums.setCapacity(capacity);
+    clear();
+}
+
+void WindowStatistics::clear() {
+    minimums.clear();
+    maximums.clear();
+    sum = 0;
+    pushed = popped = 0;
+    for (unsigned int &bin : histogram)
+        bin = 0;
+}
+
+void WindowStatistics::push(int value) {
+    value = clamp(value);
+
+    // older values that can never be the minimum (maximum) again are dropped
+    while (!minimums.empty() && minimums.back().value >= value)
+        minimums.pop_back();
+    minimums.push_back({value, pushed});
+
+    while (!maximums.empty() && maximums.back().value <= value)
+        maximums.pop_back();
+    maximums.push_back({value, pushed});
+
+    sum += value;
+    histogram[value]++;
+    pushed++;
+}
+
+void WindowStatistics::pop(int value) {
+    value = clamp(value);
+
+    if (!minimums.empty() && minimums.front().sequence == popped)
+        minimums.pop_front();
+    if (!maximums.empty() && maximums.front().sequence == popped)
+        maximums.pop_front();
+
+    sum -= value;
+    histogram[value]--;
+    popped++;
+}
+
+int WindowStatistics::average() const {
+    unsigned long count = pushed - popped;
+    return count == 0 ? 0 : sum / (long) count;
+}
+
+int WindowStatistics::minimum() const {
+    return minimums.empty() ? 0 : minimums.front().value;
+}
+
+int WindowStatistics::maximum() const {
+    return maximums.empty() ? 0 : maximums.front().value;
+}
+
+int WindowStatistics::percentile(const float p) const {
+    unsigned long count = pushed - popped;
+    if (count == 0)
+        return 0;
+
+    // nearest-rank method
+    auto rank = (unsigned long) std::ceil(p * count);
+    if (rank == 0)
+        rank = 1;
+
+    unsigned long seen = 0;
+    for (int value = 0; value <= STATISTICS_MAX_VALUE; value++) {
+        seen += histogram[value];
+        if (seen >= rank)
+            return value;
+    }
+
+    return STATISTICS_MAX_VALUE;
+}
@@ -0,0 +1,49 @@
+#ifndef STATISTICS_H
+#define STATISTICS_H
+
+#include "ringbuffer.h"
+
+#define STATISTICS_MAX_VALUE 100 // values are percentages
+
+/**
+ * Average, minimum, maximum and percentiles of a sliding window of values
+ * in [0; STATISTICS_MAX_VALUE]. Values must leave the window in the order
+ * they entered it. push() and pop() are amortized O(1): the average is a
+ * running sum, minimum and maximum are kept in monotonic deques, and
+ * percentiles come from a histogram with one bin per possible value, which
+ * is an exact quantile sketch for this small integer domain
+ */
+class WindowStatistics {
+public:
+    // capacity is the maximum number of values in the window
+    void setCapacity(size_t capacity);
+
+    // value enters the window as the newest one
+    void push(int value);
+
+    // the oldest value leaves the window
+    void pop(int value);
+
+    // every value leaves the window
+    void clear();
+
+    int average() const;
+    int minimum() const;
+    int maximum() const;
+
+    // p in [0; 1]
+    int percentile(float p) const;
+
+private:
+    struct Entry {
+        int value;
+        unsigned long sequence;
+    };
+
+    long sum = 0;
+    unsigned long pushed = 0, popped = 0;
+    RingBuffer<Entry> minimums, maximums; // increasing / decreasing values, oldest first
+    unsigned int histogram[STATISTICS_MAX_VALUE + 1] = {};
+};
+
+#endif
@@ -0,0 +1,125 @@
+#include "stream.h"
+
+#include <iostream>
+#include <csignal>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "constants.h"
+#include "utils.h"
+
+#define BUFFER_SIZE 4096
+
+StreamReader::StreamReader(const std::string &cmd, const long timeout): cmd(cmd), timeout(timeout) {}
+
+StreamReader::~StreamReader() {
+    stop();
+}
+
+void StreamReader::start() {
+    // close-on-exec from the start: a child that run() spawns on another thread
+    // between pipe and fork would otherwise inherit the write end, and we would never see EOF
+    int fds[2];
+    if (pipe2(fds, O_CLOEXEC) != 0) {
+        std::cout << "StreamReader: pipe2() failed for " << cmd << "\n";
+        return;
+    }
+
+    std::string shellCmd = "exec " + cmd; // built before fork(), the child must not allocate
+    lastStart = lastRead = getTime();
+    pid = fork();
+
+    if (pid == 0) {
+        // child: only async-signal-safe calls from here
+        sigset_t none;
+        sigemptyset(&none);
+        sigprocmask(SIG_SETMASK, &none, nullptr); // the headless collector blocks SIGTERM in all its threads
+        dup2(fds[1], STDOUT_FILENO); // dup2() clears FD_CLOEXEC on the copy
+        int input = open("/dev/null", O_RDONLY | O_CLOEXEC);
+        if (input >= 0)
+            dup2(input, STDIN_FILENO);
+        int null = open("/dev/null", O_WRONLY | O_CLOEXEC);
+        if (null >= 0)
+            dup2(null, STDERR_FILENO);
+        execl("/bin/sh", "sh", "-c", shellCmd.c_str(), (char*) nullptr);
+        _exit(127);
+    }
+
+    close(fds[1]);
+
+    if (pid < 0) {
+        std::cout << "StreamReader: fork() failed for " << cmd << "\n";
+        close(fds[0]);
+        return;
+    }
+
+    countSpawn();
+    fd = fds[0];
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+}
+
+void StreamReader::stop() {
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+
+    // a hung nvidia-smi may not even react to SIGKILL, it must not block the worker
+    if (pid > 0) {
+        kill(pid, SIGTERM);
+        reap(pid);
+        pid = -1;
+    }
+
+    buffer.clear();
+}
+
+bool StreamReader::isRunning() const {
+    return fd >= 0;
+}
+
+void StreamReader::poll(const std::function<void(std::string_view line)> &onLine) {
+    if (fd < 0) {
+        // do not respawn a child that keeps failing more often than NVSM_STREAM_RESTART_DELAY
+        if (lastStart != 0 && getTime() - lastStart < NVSM_STREAM_RESTART_DELAY)
+            return;
+        start();
+        if (fd < 0)
+            return;
+    }
+
+    char chunk[BUFFER_SIZE];
+    ssize_t count;
+
+    while ((count = read(fd, chunk, sizeof chunk)) != 0) {
+        if (count < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                if (getTime() - lastRead <= timeout)
+                    return; // nothing more for now, child is still alive
+
+                std::cout << "StreamReader: " << cmd << " printed nothing for " << timeout << " ms, restarting\n";
+                stop();
+                return;
+            }
+
+            break;
+        }
+
+        buffer.append(chunk, count);
+        lastRead = getTime();
+
+        size_t begin = 0, end;
+        while ((end = buffer.find('\n', begin)) != std::string::npos) {
+            onLine(std::string_view(buffer).substr(begin, end - begin));
+            begin = end + 1;
+        }
+        buffer.erase(0, begin);
+    }
+
+    // EOF or read error: the child has died, it will be restarted on next poll
+    std::cout << "StreamReader: " << cmd << " exited, restarting\n";
+    stop();
+}
@@ -0,0 +1,40 @@
+#ifndef STREAM_H
+#define STREAM_H
+
+#include <string>
+#include <string_view>
+#include <functional>
+#include <sys/types.h>
+
+/**
+ * Long-lived child process whose stdout is read incrementally without blocking.
+ * The child is (re)started lazily from poll(), so it is restarted automatically
+ * if it dies, or if it has printed nothing for timeout ms
+ */
+class StreamReader {
+public:
+    StreamReader(const std::string &cmd, long timeout);
+    ~StreamReader();
+
+    // reads everything currently available and calls onLine for each complete line
+    void poll(const std::function<void(std::string_view line)> &onLine);
+
+    bool isRunning() const;
+
+    // time of the last output, or of the start if there was none yet
+    long getLastRead() const { return lastRead; }
+
+private:
+    std::string cmd;
+    std::string buffer; // incomplete line left from the previous read, capacity is reused
+    pid_t pid = -1;
+    int fd = -1;
+    long lastStart = 0;
+    long lastRead = 0;
+    long timeout;
+
+    void start();
+    void stop();
+};
+
+#endif
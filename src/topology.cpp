@@ -0,0 +1,89 @@
+#include "topology.h"
+
+#define FNV_OFFSET 14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
+
+static void hash(uint64_t &h, const void *data, const size_t size) {
+    const auto *bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++) {
+        h ^= bytes[i];
+        h *= FNV_PRIME;
+    }
+}
+
+std::string gpuKey(const GPUSample &gpu, const size_t index) {
+    if (!gpu.uuid.empty())
+        return gpu.uuid;
+
+    return "#" + std::to_string(index) + " " + gpu.name;
+}
+
+// hashes what gpuKey() consists of
+uint64_t gpuFingerprint(const std::vector<GPUSample> &gpus) {
+    uint64_t h = FNV_OFFSET;
+
+    for (size_t i = 0; i < gpus.size(); i++) {
+        const GPUSample &gpu = gpus[i];
+
+        if (!gpu.uuid.empty()) {
+            hash(h, gpu.uuid.data(), gpu.uuid.size());
+        } else {
+            hash(h, &i, sizeof i);
+            hash(h, gpu.name.data(), gpu.name.size());
+        }
+
+        hash(h, "", 1); // separator, so keys can not run into each other
+    }
+
+    return h;
+}
+
+std::vector<int> remapGPUs(std::vector<std::string> &keys, const std::vector<GPUSample> &gpus) {
+    std::unordered_map<std::string, int> previous;
+    for (size_t GPU = 0; GPU < keys.size(); GPU++)
+        previous.emplace(keys[GPU], GPU);
+
+    std::vector<std::string> next(gpus.size());
+    std::vector<int> from(gpus.size(), -1);
+    for (size_t GPU = 0; GPU < gpus.size(); GPU++) {
+        next[GPU] = gpuKey(gpus[GPU], GPU);
+
+        auto it = previous.find(next[GPU]);
+        if (it != previous.end()) {
+            from[GPU] = it->second;
+            previous.erase(it); // a key is only taken once
+        }
+    }
+
+    keys.swap(next);
+
+    return from;
+}
+
+bool GPUMetadataCache::update(const std::vector<GPUSample> &gpus) {
+    uint64_t next = gpuFingerprint(gpus);
+    if (generation > 0 && next == fingerprint)
+        return false;
+
+    fingerprint = next;
+    generation++;
+
+    auto result = std::make_shared<GPUTopology>();
+    result->fingerprint = fingerprint;
+    result->generation = generation;
+
+    for (size_t i = 0; i < gpus.size(); i++) {
+        GPUInfo info;
+        info.key = gpuKey(gpus[i], i);
+        info.uuid = gpus[i].uuid;
+        info.name = gpus[i].name;
+        info.memoryTotal = gpus[i].memoryTotal;
+
+        result->indexes.emplace(info.key, i);
+        result->gpus.push_back(std::move(info));
+    }
+
+    topology.store(std::move(result));
+
+    return true;
+}
@@ -0,0 +1,57 @@
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "source.h"
+#include "snapshot.h"
+
+// what does not change while a GPU is there
+struct GPUInfo {
+    std::string key; // see gpuKey()
+    std::string uuid; // empty if the source does not report it
+    std::string name;
+    int memoryTotal = 0; // MiB
+};
+
+struct GPUTopology {
+    std::vector<GPUInfo> gpus; // by index
+    std::unordered_map<std::string, size_t> indexes; // key -> index
+    uint64_t fingerprint = 0;
+    unsigned long generation = 0; // grows with every change
+};
+
+// identifies a GPU across samples: its UUID, or index and name for sources without one
+std::string gpuKey(const GPUSample &gpu, size_t index);
+
+// hash of the keys of all GPUs in order, without building them: same GPUs at the same indexes, same hash
+uint64_t gpuFingerprint(const std::vector<GPUSample> &gpus);
+
+// where the state of every GPU of a new sample is: the index in keys of the GPU with the same key, -1 for a
+// GPU that is new; keys is replaced by the keys of gpus
+std::vector<int> remapGPUs(std::vector<std::string> &keys, const std::vector<GPUSample> &gpus);
+
+/**
+ * Metadata of the GPUs, keyed by UUID. update() only hashes the identities
+ * of a sample; the topology is rebuilt when the hash changes, i.e. when a
+ * GPU appeared or fell off the bus, or MIG changed the devices
+ */
+class GPUMetadataCache {
+public:
+    // returns true if the topology changed
+    bool update(const std::vector<GPUSample> &gpus);
+
+    // never blocks, for any thread
+    std::shared_ptr<const GPUTopology> get() const { return topology.load(); }
+
+private:
+    Snapshot<GPUTopology> topology;
+    uint64_t fingerprint = 0;
+    unsigned long generation = 0;
+};
+
+#endif
@@ -3,262 +3,501 @@
 #include <QApplication>
 #include <QToolTip>
 #include <QMouseEvent>
+#include <algorithm>
 
 #include "settings.h"
 #include "utils.h"
 #include "constants.h"
+#include "topology.h"
 
 #define graphHeightCoef 9
-int grapthStartY, grapthEndY, width;
 
-void drawGrid(QWidget* widget, QPainter* p, const char* name)
+void drawGrid(const GraphGeometry& geometry, const QFontMetrics& fontMetrics, QPainter* p, const char* name)
 {
-	QFontMetrics fm(qApp->font());
-	int x0, y0 = fm.height(), graphHeight = graphHeightCoef * y0;
-	width = widget->size().width() - 4;
+	int x0, y0 = geometry.fontHeight, graphHeight = geometry.endY - geometry.startY;
 
 	p->setPen(QColor(100, 100, 100));
-	grapthStartY = y0 * 1.25f;
-	grapthEndY = grapthStartY + graphHeight;
 	for (float i = 0; i <= 1.0f; i += 0.25f)
 	{
-		p->drawLine(width * i, grapthStartY, width * i, grapthStartY + graphHeight);
-		p->drawLine(0, grapthStartY + graphHeight * i, width, grapthStartY + graphHeight * i);
+		p->drawLine(geometry.width * i, geometry.startY, geometry.width * i, geometry.endY);
+		p->drawLine(0, geometry.startY + graphHeight * i, geometry.width, geometry.startY + graphHeight * i);
 	}
 
 	p->setPen(QApplication::palette().text().color());
 	p->drawText(0, y0, name);
-	p->drawText(0, grapthEndY + y0, (toString(GRAPH_LENGTH / 1000.0f) + " sec").c_str());
+	p->drawText(0, geometry.endY + y0, (toString(GRAPH_LENGTH / 1000.0f) + " sec").c_str());
 
 	QString text = "100%";
-	x0 = fm.horizontalAdvance(text);
-	p->drawText(width - x0, y0, text);
+	x0 = fontMetrics.horizontalAdvance(text);
+	p->drawText(geometry.width - x0, y0, text);
 
 	text = "0%";
-	x0 = fm.horizontalAdvance(text);
-	p->drawText(width - x0, grapthEndY + y0, text);
+	x0 = fontMetrics.horizontalAdvance(text);
+	p->drawText(geometry.width - x0, geometry.endY + y0, text);
 }
 
-void drawGraph(UtilizationWorker* worker, QPainter* p)
+// the finest history that holds the whole graph without many more points than there are pixels,
+// nullptr for the raw points
+static const HistoryTier* selectTier(const RingBuffer<Point>& points, const std::vector<HistoryTier>& tiers, int width)
 {
-	int x1, y1, x2, y2;
+	size_t limit = NVSM_HISTORY_POINTS_PER_PIXEL * (size_t)(width > 0 ? width : 1);
+
+	if (tiers.empty() || (GRAPH_POINTS <= points.capacity() && points.size() <= limit))
+		return nullptr;
+
+	for (const HistoryTier& tier : tiers)
+	{
+		if (tier.covers(GRAPH_LENGTH) && (size_t)(GRAPH_LENGTH / tier.resolution) <= limit)
+			return &tier;
+	}
+
+	return &tiers.back();
+}
+
+// min/max decimation: at most two vertices per pixel column, in the order they were sampled,
+// so the vertex count is bounded by the width and peaks are kept.
+// x(i) is the column of item i, low(i) and high(i) its range
+template<typename X, typename Low, typename High>
+static void decimate(QPolygonF& vertices, size_t count, X x, Low low, High high)
+{
+	int column = x(0);
+	size_t lowest = 0, highest = 0;
+	for (size_t i = 1; i <= count; i++)
+	{
+		if (i < count && x(i) == column)
+		{
+			if (low(i) < low(lowest))
+				lowest = i;
+			if (high(i) > high(highest))
+				highest = i;
+			continue;
+		}
+
+		QPointF first(column, lowest <= highest ? low(lowest) : high(highest));
+		QPointF second(column, lowest <= highest ? high(highest) : low(lowest));
+		vertices.append(first);
+		if (second.y() != first.y())
+			vertices.append(second);
+
+		if (i < count)
+		{
+			column = x(i);
+			lowest = highest = i;
+		}
+	}
+}
+
+void drawGraph(const GraphGeometry& geometry, const UtilizationView& view, QPainter* p, QPolygonF& vertices)
+{
+	long latest;
 	QColor color;
 	QPen pen;
 	pen.setWidth(2);
-	for (int g = 0; g < GPU_COUNT; g++)
+
+	// the newest point is at the right edge, older points move left by their age
+	#define _x(time) (int)((1.0f - (float)(latest - (time)) / GRAPH_LENGTH) * geometry.width)
+	#define _y(value) (geometry.endY - (geometry.endY - geometry.startY) / 100.0f * (value))
+
+	for (size_t g = 0; g < view.graphPoints.size(); g++)
 	{
-		color = gpuColors[g];
-		pen.setColor(color);
-		p->setPen(pen);
-		for (size_t i = 1; i < worker->graphPoints[g].size(); i++)
-		{
-			x1 = worker->graphPoints[g][i - 1].x * width;
-			y1 = grapthEndY - (grapthEndY - grapthStartY) / 100.0f * worker->graphPoints[g][i - 1].y;
-			x2 = worker->graphPoints[g][i].x * width;
-			y2 = grapthEndY - (grapthEndY - grapthStartY) / 100.0f * worker->graphPoints[g][i].y;
-
-			QPainterPath filling;
-			filling.moveTo(x1, y1);
-			filling.lineTo(x2, y2);
-			filling.lineTo(x2, grapthEndY);
-			filling.lineTo(x1, grapthEndY);
-			filling.lineTo(x1, y1);
-			color.setAlpha(64);
-			p->fillPath(filling, QBrush(color));
+		const RingBuffer<Point>& points = view.graphPoints[g];
+		if (points.size() < 2)
+			continue;
+
+		latest = points.back().time;
+		vertices.clear();
 
-			p->drawLine(x1, y1, x2, y2);
+		const HistoryTier* tier = selectTier(points, view.history[g], geometry.width);
+		if (!tier)
+		{
+			decimate(vertices, points.size(),
+				[&](size_t i) { return _x(points[i].time); },
+				[&](size_t i) { return _y(points[i].y); },
+				[&](size_t i) { return _y(points[i].y); });
+		}
+		else
+		{
+			// a bucket is drawn in its middle, the newest one is still filling
+			const RingBuffer<Bucket>& buckets = tier->buckets;
+			long half = tier->resolution / 2;
+			decimate(vertices, buckets.size(),
+				[&](size_t i) { return _x(std::min(buckets[i].time + half, latest)); },
+				[&](size_t i) { return _y(buckets[i].max); }, // y grows down, the highest value is the lowest y
+				[&](size_t i) { return _y(buckets[i].min); });
 		}
+
+		if (vertices.size() < 2)
+			continue;
+
+		color = gpuColors[g % 8];
+		pen.setColor(color);
+		int lineSize = vertices.size();
+
+		// the same buffer closed along the bottom of the graph is the filling
+		vertices.append(QPointF(vertices.last().x(), geometry.endY));
+		vertices.append(QPointF(vertices.first().x(), geometry.endY));
+		color.setAlpha(64);
+		p->setPen(Qt::NoPen);
+		p->setBrush(QBrush(color));
+		p->drawPolygon(vertices.constData(), vertices.size());
+
+		p->setPen(pen);
+		p->setBrush(QBrush());
+		p->drawPolyline(vertices.constData(), lineSize);
 	}
+
+	#undef _x
+	#undef _y
 }
 
-void drawStatusObjects(std::vector<QRect>& statusObjectsAreas, UtilizationData* utilizationData, QPainter* p)
+// ring outlines and names only move when the widget, the font or the GPU names change
+void drawStatusOutlines(const GraphGeometry& geometry, const QFontMetrics& fontMetrics, std::vector<QRect>& statusObjectsAreas,
+						const std::vector<UtilizationData>& utilizationData, QPainter* p)
 {
 	statusObjectsAreas.clear();
-	QFontMetrics fontMetric(qApp->font());
-	int size = fontMetric.height() * 2; 					// width and height for progress arc
-	int spanAngle, x, y, textWidth, nameWidth;
+	int size = geometry.fontHeight * 2; 					// width and height for progress arc
+	int x, y, textWidth, nameWidth;
 	int blockSize, horizontalCount;
-	QRect progress;
 
-	for (int GPU = 0; GPU < GPU_COUNT; GPU++)
+	p->setPen(QApplication::palette().text().color());
+	p->setBrush(QBrush());
+
+	for (size_t GPU = 0; GPU < utilizationData.size(); GPU++)
 	{
 
 		if (utilizationData[GPU].maximum == 100.0)
-			textWidth = fontMetric.horizontalAdvance("100%");	// calc max width
+			textWidth = fontMetrics.horizontalAdvance("100%");	// calc max width
 		else
-			textWidth = fontMetric.horizontalAdvance("00000 / 00000 MB");
-		nameWidth = fontMetric.horizontalAdvance(utilizationData[GPU].name.c_str());
+			textWidth = fontMetrics.horizontalAdvance("00000 / 00000 MB");
+		nameWidth = fontMetrics.horizontalAdvance(utilizationData[GPU].name.c_str());
 		textWidth = textWidth > nameWidth ? textWidth : nameWidth;
 		blockSize = size + STATUS_OBJECT_TEXT_OFFSET + textWidth + STATUS_OBJECT_OFFSET;
-		horizontalCount = (width + STATUS_OBJECT_OFFSET) / blockSize; // (width + STATUS_OBJECT_OFFSET) because last element has offset
-
-		p->setPen(gpuColors[GPU]);
-		p->setBrush(QBrush(gpuColors[GPU]));
+		horizontalCount = (geometry.width + STATUS_OBJECT_OFFSET) / blockSize; // (width + STATUS_OBJECT_OFFSET) because last element has offset
+		horizontalCount = horizontalCount > 0 ? horizontalCount : 1;
 
 		x = blockSize * (GPU % horizontalCount);
-		y = grapthEndY + fontMetric.height() + (size + STATUS_OBJECT_OFFSET) * (GPU / horizontalCount) + GRAPTH_OFFSET;
-		spanAngle = -utilizationData[GPU].level / utilizationData[GPU].maximum * 360;
+		y = geometry.endY + geometry.fontHeight + (size + STATUS_OBJECT_OFFSET) * (GPU / horizontalCount) + GRAPTH_OFFSET;
+
+		p->drawEllipse(x, y, size, size);
+		p->drawText(x + size + STATUS_OBJECT_TEXT_OFFSET, y + size / 2 - geometry.xHeight / 2, (utilizationData[GPU].name.c_str()));
+
+		statusObjectsAreas.emplace_back(x, y, blockSize, size);
+	}
+}
+
+void drawStatusObjects(const GraphGeometry& geometry, const std::vector<QRect>& statusObjectsAreas, const std::vector<UtilizationData>& utilizationData, QPainter* p)
+{
+	int spanAngle, x, y, size;
+
+	for (size_t GPU = 0; GPU < statusObjectsAreas.size() && GPU < utilizationData.size(); GPU++)
+	{
+		x = statusObjectsAreas[GPU].x();
+		y = statusObjectsAreas[GPU].y();
+		size = statusObjectsAreas[GPU].height();
+		spanAngle = utilizationData[GPU].maximum > 0 ? -utilizationData[GPU].level / utilizationData[GPU].maximum * 360 : 0;
 
-		progress = QRect(x, y, size, size);
+		// inside the cached outline
+		QRect progress(x + 1, y + 1, size - 2, size - 2);
 
 		QPainterPath progressPath;
 		progressPath.moveTo(x + size / 2, y + size / 2);
 		progressPath.arcTo(progress, 90, spanAngle);
+		QColor color = gpuColors[GPU % 8];
+		if (utilizationData[GPU].stale)
+			color.setAlpha(64);
+		p->setPen(Qt::NoPen);
+		p->setBrush(QBrush(color));
 		p->drawPath(progressPath);
 
 		p->setPen(QApplication::palette().text().color());
 		p->setBrush(QBrush());
-		p->drawEllipse(x, y, size, size);
 
-		if (utilizationData[GPU].maximum == 100.0f)
+		if (utilizationData[GPU].stale)
 		{
-			p->drawText(x + size + STATUS_OBJECT_TEXT_OFFSET, y + size / 2 - fontMetric.xHeight() / 2, (utilizationData[GPU].name.c_str()));
-			p->drawText(x + size + STATUS_OBJECT_TEXT_OFFSET, y + size / 2 + int(fontMetric.xHeight() * 1.5), (std::to_string(utilizationData[GPU].level) + "%").c_str());
+			p->setPen(QColor(220, 0, 0));
+			p->drawText(x + size + STATUS_OBJECT_TEXT_OFFSET, y + size / 2 + int(geometry.xHeight * 1.5), "stale");
 		}
+		else if (utilizationData[GPU].maximum == 100.0f)
+			p->drawText(x + size + STATUS_OBJECT_TEXT_OFFSET, y + size / 2 + int(geometry.xHeight * 1.5), (std::to_string(utilizationData[GPU].level) + "%").c_str());
 		else
-		{
-			p->drawText(x + size + STATUS_OBJECT_TEXT_OFFSET, y + size / 2 - fontMetric.xHeight() / 2, (utilizationData[GPU].name.c_str()));
-			p->drawText(x + size + STATUS_OBJECT_TEXT_OFFSET, y + size / 2 + int(fontMetric.xHeight() * 1.5), (std::to_string(utilizationData[GPU].level) + " / " + std::to_string(int(utilizationData[GPU].maximum)) + " MB").c_str());
-		}
-
-		statusObjectsAreas.emplace_back(x, y, blockSize, size);
+			p->drawText(x + size + STATUS_OBJECT_TEXT_OFFSET, y + size / 2 + int(geometry.xHeight * 1.5), (std::to_string(utilizationData[GPU].level) + " / " + std::to_string(int(utilizationData[GPU].maximum)) + " MB").c_str());
 	}
 }
 
-Point::Point(const float x, const int y)
+Point::Point(const long time, const int y)
 {
-	this->x = x;
+	this->time = time;
 	this->y = y;
 }
 
+// no GPUs until the first sample
 UtilizationWorker::UtilizationWorker()
 {
-	graphPoints = new std::vector<Point>[GPU_COUNT];
-	utilizationData = new UtilizationData[GPU_COUNT];
+	fingerprint = gpuFingerprint(std::vector<GPUSample>());
 }
 
-void UtilizationWorker::work()
+void UtilizationWorker::setup(const uint index)
 {
-	mutex.lock();
+	graphPoints[index].setCapacity(GRAPH_CAPACITY);
+	statistics[index].setCapacity(GRAPH_CAPACITY);
 
-	if (lastTime == 0)
+	// a tier is only useful if it is coarser than the samples and has more than one bucket in the graph
+	for (long resolution : NVSM_HISTORY_RESOLUTIONS)
 	{
-		lastTime = getTime();
-		mutex.unlock();
+		if (resolution <= (long)UPDATE_DELAY || resolution >= (long)GRAPH_LENGTH)
+			continue;
+
+		HistoryTier tier;
+		size_t buckets = GRAPH_LENGTH / resolution + 2;
+		tier.setup(resolution, buckets < NVSM_HISTORY_TIER_POINTS ? buckets : NVSM_HISTORY_TIER_POINTS);
+		history[index].push_back(tier);
+	}
+}
+
+// the state follows its GPU by key: a GPU that vanished takes its graph along,
+// the others keep theirs even if their indexes shift
+void UtilizationWorker::updateTopology(const std::vector<GPUSample>& gpus)
+{
+	remap(remapGPUs(keys, gpus));
+}
+
+template<typename T>
+static void reorder(std::vector<T>& items, const std::vector<int>& from)
+{
+	std::vector<T> result(from.size());
+	for (size_t i = 0; i < from.size(); i++)
+	{
+		if (from[i] >= 0)
+			result[i] = std::move(items[from[i]]);
+	}
+
+	items.swap(result);
+}
+
+void UtilizationWorker::remap(const std::vector<int>& from)
+{
+	reorder(graphPoints, from);
+	reorder(history, from);
+	reorder(statistics, from);
+	reorder(utilizationData, from);
+
+	for (size_t GPU = 0; GPU < from.size(); GPU++)
+	{
+		if (from[GPU] < 0)
+			setup(GPU);
+	}
+}
+
+void UtilizationWorker::work()
+{
+	// nothing received yet, e.g. streaming nvidia-smi is still starting
+	if (sampler->gpus.empty())
 		return;
+
+	// a failed sample adds no point, the graph keeps the gap
+	mutex.lock();
+	if (sampler->stale)
+	{
+		for (UtilizationData& data : utilizationData)
+			data.stale = true;
 	}
+	else
+		addSample(getTime(), sampler->gpus);
+	publish();
+	mutex.unlock();
 
-	receiveData();
+	dataUpdated();
+}
+
+void UtilizationWorker::addSample(const long time, const std::vector<GPUSample>& gpus)
+{
+	// hashing the GPUs is cheap, the state is only moved when they changed
+	uint64_t next = gpuFingerprint(gpus);
+	if (next != fingerprint)
+	{
+		updateTopology(gpus);
+		fingerprint = next;
+	}
 
-	float step = (float)(getTime() - lastTime) / UPDATE_DELAY * GRAPH_STEP;
+	receiveData(gpus);
 
-	for (int GPU = 0; GPU < GPU_COUNT; GPU++)
+	for (size_t GPU = 0; GPU < gpus.size(); GPU++)
 	{
-		for (Point& i : graphPoints[GPU])
-			i.x -= step;
+		utilizationData[GPU].stale = false;
 
-		graphPoints[GPU].emplace_back(1.0f, utilizationData[GPU].level * 100 / utilizationData[GPU].maximum);
+		// a source that reports no memory total gives no maximum, its points are 0
+		const UtilizationData& data = utilizationData[GPU];
+		Point point(time, data.maximum > 0 ? data.level * 100 / data.maximum : 0);
+		addPoint(GPU, point);
 		deleteSuperfluousPoints(GPU);
 
-		// calculate average, min, max
-		utilizationData[GPU].avgLevel = utilizationData[GPU].maxLevel = 0;
-		utilizationData[GPU].minLevel = 100;
-		for (size_t i = 0; i < graphPoints[GPU].size(); i++)
-		{
-			utilizationData[GPU].avgLevel += graphPoints[GPU][i].y;
-			if (utilizationData[GPU].maxLevel < graphPoints[GPU][i].y)
-				utilizationData[GPU].maxLevel = graphPoints[GPU][i].y;
-			if (utilizationData[GPU].minLevel > graphPoints[GPU][i].y)
-				utilizationData[GPU].minLevel = graphPoints[GPU][i].y;
-		}
-		utilizationData[GPU].avgLevel /= graphPoints[GPU].size();
+		for (HistoryTier& tier : history[GPU])
+			tier.add(point.time, point.y);
+
+		utilizationData[GPU].avgLevel = statistics[GPU].average();
+		utilizationData[GPU].minLevel = statistics[GPU].minimum();
+		utilizationData[GPU].maxLevel = statistics[GPU].maximum();
+		utilizationData[GPU].p50Level = statistics[GPU].percentile(0.50f);
+		utilizationData[GPU].p95Level = statistics[GPU].percentile(0.95f);
+		utilizationData[GPU].p99Level = statistics[GPU].percentile(0.99f);
 	}
+}
 
-	mutex.unlock();
-	dataUpdated();
+void UtilizationWorker::clear()
+{
+	for (size_t GPU = 0; GPU < graphPoints.size(); GPU++)
+	{
+		graphPoints[GPU].clear();
+		statistics[GPU].clear();
 
-	lastTime = getTime();
+		for (HistoryTier& tier : history[GPU])
+			tier.clear();
+	}
 }
 
-void UtilizationWorker::deleteSuperfluousPoints(const uint index)
+// copied once per sample, so painting and the servers only hold a pointer
+void UtilizationWorker::publish()
 {
-	if (graphPoints[index].size() > 2 && graphPoints[index][0].x < 0 && graphPoints[index][1].x <= 0)
-		graphPoints[index].erase(graphPoints[index].begin());
+	auto next = std::make_shared<UtilizationView>();
+	next->graphPoints = graphPoints;
+	next->history = history;
+	next->utilizationData = utilizationData;
+	fillView(*next);
+	view.store(std::move(next));
 }
 
-UtilizationWorker::~UtilizationWorker()
+// every point that enters or leaves graphPoints goes through statistics too
+void UtilizationWorker::addPoint(const uint index, const Point& point)
 {
-	delete[] graphPoints;
-	delete[] utilizationData;
+	RingBuffer<Point>& points = graphPoints[index];
+
+	if (points.full())
+	{
+		statistics[index].pop(points.front().y);
+		points.pop_front();
+	}
+
+	points.push_back(point);
+	statistics[index].push(point.y);
 }
 
-void GPUUtilizationWorker::receiveData()
+// keeps exactly one point beyond the left edge of the graph, so the line reaches the edge
+void UtilizationWorker::deleteSuperfluousPoints(const uint index)
 {
-	std::vector<std::string> lines = split(exec(NVSMI_CMD_GPU_UTILIZATION), "\n");
-	std::vector<std::string> GPUs = split(streamline(exec(NVSMI_LIST_GPUS)), "\n");
-	// fake, "emulated" GPUs
-//    lines[2] = std::to_string(50 + rand() % 20) + " %";
-//    lines.push_back(std::to_string(30 + rand() % 10) + " %");
-//    lines.push_back(std::to_string(70 + rand() % 30) + " %");
-//    lines.push_back("");
-	for (size_t i = 1; i < lines.size() - 1; i++)
+	RingBuffer<Point>& points = graphPoints[index];
+	long edge = points.back().time - GRAPH_LENGTH;
+
+	while (points.size() > 2 && points[1].time <= edge)
 	{
-		utilizationData[i - 1].name = GPUs[i];
-		utilizationData[i - 1].level = std::atoi(split(lines[i], " ")[0].c_str());
+		statistics[index].pop(points.front().y);
+		points.pop_front();
 	}
 }
 
-MemoryUtilizationWorker::MemoryUtilizationWorker() : UtilizationWorker()
+void GPUUtilizationWorker::receiveData(const std::vector<GPUSample>& gpus)
 {
-	memoryData = new MemoryData[GPU_COUNT];
+	for (size_t GPU = 0; GPU < gpus.size(); GPU++)
+	{
+		utilizationData[GPU].name = gpus[GPU].name;
+		utilizationData[GPU].level = gpus[GPU].utilization;
+	}
 }
 
-MemoryUtilizationWorker::~MemoryUtilizationWorker()
+void MemoryUtilizationWorker::remap(const std::vector<int>& from)
 {
-	delete[] memoryData;
+	UtilizationWorker::remap(from);
+	reorder(memoryData, from);
 }
 
-void MemoryUtilizationWorker::receiveData()
+void MemoryUtilizationWorker::fillView(UtilizationView& view) const
 {
-	std::vector<std::string> lines = split(exec(NVSMI_CMD_MEM_UTILIZATION), "\n"), data;
-	std::vector<std::string> GPUs = split(streamline(exec(NVSMI_LIST_GPUS)), "\n");
-	for (size_t GPU = 1; GPU < lines.size() - 1; GPU++)
+	view.memoryData = memoryData;
+}
+
+void MemoryUtilizationWorker::receiveData(const std::vector<GPUSample>& gpus)
+{
+	for (size_t GPU = 0; GPU < gpus.size(); GPU++)
 	{
-		data = split(lines[GPU], ", ");
-		memoryData[GPU - 1].total = std::atoi(split(data[1], " ")[0].c_str());
-		memoryData[GPU - 1].free = std::atoi(split(data[2], " ")[0].c_str());
-		memoryData[GPU - 1].used = std::atoi(split(data[3], " ")[0].c_str());
-		utilizationData[GPU - 1].level = memoryData[GPU - 1].used;
-		utilizationData[GPU - 1].maximum = memoryData[GPU - 1].total;
-		utilizationData[GPU - 1].name = GPUs[GPU];
+		memoryData[GPU].total = gpus[GPU].memoryTotal;
+		memoryData[GPU].free = gpus[GPU].memoryFree;
+		memoryData[GPU].used = gpus[GPU].memoryUsed;
+		utilizationData[GPU].level = memoryData[GPU].used;
+		utilizationData[GPU].maximum = memoryData[GPU].total;
+		utilizationData[GPU].name = gpus[GPU].name;
 	}
 }
 
+// names and units decide where the status objects are
+static std::string layoutKey(const std::vector<UtilizationData>& utilizationData)
+{
+	std::string key;
+	for (const UtilizationData& data : utilizationData)
+		key += data.name + (data.maximum == 100.0 ? " %\n" : " MB\n");
+	return key;
+}
+
 void UtilizationWidget::paintEvent(QPaintEvent*)
 {
+	std::shared_ptr<const UtilizationView> view = worker->view.load();
+
+	std::string key = layoutKey(view->utilizationData);
+	if (backgroundChanged || backgroundSize != size() || backgroundKey != key)
+	{
+		backgroundKey = key;
+		updateBackground(view->utilizationData);
+	}
+
 	QPainter p;
 	p.begin(this);
+	p.drawPixmap(0, 0, background);
 	p.setRenderHint(QPainter::Antialiasing);
-	drawGrid(this, &p, this->GetName());
-	QMutexLocker locker(&worker->mutex);
-	drawGraph(worker, &p);
-	drawStatusObjects(statusObjectsAreas, worker->utilizationData, &p);
+	drawGraph(geometry, *view, &p, graphVertices);
+	drawStatusObjects(geometry, statusObjectsAreas, view->utilizationData, &p);
 	p.end();
 }
 
-void UtilizationWidget::onDataUpdated()
+void UtilizationWidget::changeEvent(QEvent* event)
 {
-	update();
+	if (event->type() == QEvent::FontChange || event->type() == QEvent::PaletteChange)
+		backgroundChanged = true;
+
+	QWidget::changeEvent(event);
+}
+
+void UtilizationWidget::updateBackground(const std::vector<UtilizationData>& utilizationData)
+{
+	QFontMetrics fontMetrics(font());
+	geometry.fontHeight = fontMetrics.height();
+	geometry.xHeight = fontMetrics.xHeight();
+	geometry.width = size().width() - 4;
+	geometry.startY = geometry.fontHeight * 1.25f;
+	geometry.endY = geometry.startY + graphHeightCoef * geometry.fontHeight;
+
+	qreal ratio = devicePixelRatioF();
+	background = QPixmap(size() * ratio);
+	background.setDevicePixelRatio(ratio);
+	background.fill(Qt::transparent);
+	backgroundSize = size();
+
+	QPainter p;
+	p.begin(&background);
+	p.setFont(font());
+	p.setRenderHint(QPainter::Antialiasing);
+	drawGrid(geometry, fontMetrics, &p, this->GetName());
+	drawStatusOutlines(geometry, fontMetrics, statusObjectsAreas, utilizationData, &p);
+	p.end();
+
+	backgroundChanged = false;
 }
 
-UtilizationWidget::~UtilizationWidget()
+void UtilizationWidget::onDataUpdated()
 {
-	delete worker;
+	update();
 }
 
-GPUUtilization::GPUUtilization()
+GPUUtilization::GPUUtilization(GPUUtilizationWorker* worker)
 {
-	worker = new GPUUtilizationWorker;
+	this->worker = worker;
 	setMouseTracking(true);
 }
 
@@ -266,40 +505,51 @@ GPUUtilization::GPUUtilization()
 
 void GPUUtilization::mouseMoveEvent(QMouseEvent* event)
 {
-	for (size_t i = 0; i < statusObjectsAreas.size(); i++)
+	// the GPUs may have changed since the status objects were laid out
+	std::shared_ptr<const UtilizationView> view = worker->view.load();
+	const std::vector<UtilizationData>& data = view->utilizationData;
+
+	for (size_t i = 0; i < statusObjectsAreas.size() && i < data.size(); i++)
 	{
 		if ((area.x() <= event->x()) && (area.x() + area.width() >= event->x()) && (area.y() <= event->y()) && (area.y() + area.height() >= event->y()))
 		{
-			QToolTip::showText(event->globalPos(), "GPU Utilization: " + QString::number(worker->utilizationData[i].level) +
-												   "\nAverage: " + QString::number(worker->utilizationData[i].avgLevel) +
-												   "\nMin: " + QString::number(worker->utilizationData[i].minLevel) +
-												   "\nMax: " + QString::number(worker->utilizationData[i].maxLevel));
+			QToolTip::showText(event->globalPos(), "GPU Utilization: " + QString::number(data[i].level) +
+												   "\nAverage: " + QString::number(data[i].avgLevel) +
+												   "\nMin: " + QString::number(data[i].minLevel) +
+												   "\nMax: " + QString::number(data[i].maxLevel) +
+												   "\nP50: " + QString::number(data[i].p50Level) +
+												   "\nP95: " + QString::number(data[i].p95Level) +
+												   "\nP99: " + QString::number(data[i].p99Level));
 
 			return;
 		}
 	}
 }
 
-MemoryUtilization::MemoryUtilization()
+MemoryUtilization::MemoryUtilization(MemoryUtilizationWorker* worker)
 {
-	worker = new MemoryUtilizationWorker;
+	this->worker = worker;
 	setMouseTracking(true);
 }
 
 void MemoryUtilization::mouseMoveEvent(QMouseEvent* event)
 {
-	for (size_t i = 0; i < statusObjectsAreas.size(); i++)
+	std::shared_ptr<const UtilizationView> view = worker->view.load();
+	const std::vector<UtilizationData>& data = view->utilizationData;
+	const std::vector<MemoryData>& memory = view->memoryData;
+
+	for (size_t i = 0; i < statusObjectsAreas.size() && i < data.size() && i < memory.size(); i++)
 	{
 		if ((area.x() <= event->x()) && (area.x() + area.width() >= event->x()) && (area.y() <= event->y()) && (area.y() + area.height() >= event->y()))
 		{
 			QToolTip::showText(event->globalPos(),
-							   "Memory Utilization: " + QString::number(worker->utilizationData[i].level) +
-							   "\nAverage: " + QString::number(worker->utilizationData[i].avgLevel) +
-							   "\nMin: " + QString::number(worker->utilizationData[i].minLevel) +
-							   "\nMax: " + QString::number(worker->utilizationData[i].maxLevel) +
-							   "\nTotal: " + QString::number(((MemoryUtilizationWorker*)worker)->memoryData[i].total) + " MiB" +
-							   "\nFree: " + QString::number(((MemoryUtilizationWorker*)worker)->memoryData[i].free) + " MiB" +
-							   "\nUsed: " +  QString::number(((MemoryUtilizationWorker*)worker)->memoryData[i].used) + " MiB");
+							   "Memory Utilization: " + QString::number(data[i].level) +
+							   "\nAverage: " + QString::number(data[i].avgLevel) +
+							   "\nMin: " + QString::number(data[i].minLevel) +
+							   "\nMax: " + QString::number(data[i].maxLevel) +
+							   "\nTotal: " + QString::number(memory[i].total) + " MiB" +
+							   "\nFree: " + QString::number(memory[i].free) + " MiB" +
+							   "\nUsed: " +  QString::number(memory[i].used) + " MiB");
 
 			return;
 		}
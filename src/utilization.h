@@ -3,69 +3,124 @@
 
 #include <QWidget>
 #include <QPainter>
+#include <QPixmap>
+#include <QFontMetrics>
+#include <QPolygonF>
 #include <vector>
 #include <QMutex>
 
 #include "constants.h"
 #include "worker.h"
+#include "ringbuffer.h"
+#include "statistics.h"
+#include "history.h"
+#include "snapshot.h"
+
+#define _c(r, g, b) QColor(r, g, b)
+
+extern QColor gpuColors[8]; // of the graphs, by GPU index, set in the config
 
 struct Point
 {
-	float x; // [0; 1]
+	long time; // ms, x is calculated from it at paint time
 	int y; // [0; 100]
 
-	Point(float x, int y);
+	Point() = default;
+	Point(long time, int y);
 };
 
 struct UtilizationData
 {
 	int level = 0; 	// current usage out of maximum
 	int avgLevel = 0, minLevel = 0, maxLevel = 0;
+	int p50Level = 0, p95Level = 0, p99Level = 0;
 	double maximum = 100;
 	std::string name;
+	bool stale = false; // the source did not answer, level is the last value it gave
+};
+
+// where a widget draws, shared by its cached background and the parts drawn on every update
+struct GraphGeometry
+{
+	int startY = 0, endY = 0, width = 0;
+	int fontHeight = 0, xHeight = 0;
 };
 
 struct MemoryData
 {
-	int total, free, used;
+	int total = 0, free = 0, used = 0;
+};
+
+// what the widgets and the servers read of a worker, per GPU by index
+struct UtilizationView
+{
+	std::vector<RingBuffer<Point>> graphPoints;
+	std::vector<std::vector<HistoryTier>> history;
+	std::vector<UtilizationData> utilizationData;
+	std::vector<MemoryData> memoryData; // of a MemoryUtilizationWorker, empty otherwise
 };
 
 class UtilizationWorker : public Worker
 {
 public:
-	std::vector<Point>* graphPoints; // graph points
-	UtilizationData* utilizationData;
+	// per GPU, by index; they follow the GPUs when these appear or vanish, written under mutex
+	std::vector<RingBuffer<Point>> graphPoints; // graph points, oldest first
+	std::vector<std::vector<HistoryTier>> history; // coarser copies of graphPoints for long graphs, finest first
+	std::vector<WindowStatistics> statistics; // of graphPoints
+	std::vector<UtilizationData> utilizationData;
+
+	// a copy of the above after every sample, readers on other threads never wait for the mutex
+	Snapshot<UtilizationView> view;
 
 	UtilizationWorker();
 
 	void work() override;
 
-	virtual void receiveData() = 0;
+	// takes gpus as the values at time, the caller holds mutex
+	void addSample(long time, const std::vector<GPUSample> &gpus);
 
-	void deleteSuperfluousPoints(uint index);
+	// forgets the graph, e.g. when a replay seeks, the caller holds mutex
+	void clear();
+
+	// stores the state into view, the caller holds mutex
+	void publish();
+
+	virtual void receiveData(const std::vector<GPUSample> &gpus) = 0;
 
-	~UtilizationWorker() override;
+	void addPoint(uint index, const Point &point);
+	void deleteSuperfluousPoints(uint index);
 
 protected:
-	long lastTime = 0;
+	// the state of GPU from[i] moves to index i, -1 - a GPU that was not there before
+	virtual void remap(const std::vector<int> &from);
+
+	// adds the state of a subclass to a view being published
+	virtual void fillView(UtilizationView&) const {}
+
+private:
+	std::vector<std::string> keys; // gpuKey() of the GPU each state belongs to
+	uint64_t fingerprint; // of the GPUs in keys
+
+	void updateTopology(const std::vector<GPUSample> &gpus);
+	void setup(uint index);
 };
 
 class GPUUtilizationWorker : public UtilizationWorker
 {
 public:
-	void receiveData() override;
+	void receiveData(const std::vector<GPUSample> &gpus) override;
 };
 
 class MemoryUtilizationWorker : public UtilizationWorker
 {
 public:
-	MemoryData* memoryData;
-
-	MemoryUtilizationWorker();
+	std::vector<MemoryData> memoryData;
 
-	~MemoryUtilizationWorker() override;
+	void receiveData(const std::vector<GPUSample> &gpus) override;
 
-	void receiveData() override;
+protected:
+	void remap(const std::vector<int> &from) override;
+	void fillView(UtilizationView &view) const override;
 };
 
 class UtilizationWidget : public QWidget
@@ -81,19 +136,30 @@ public:
 	virtual const char* GatMax() const
 	{ return "100%"; };
 
-	~UtilizationWidget() override;
-
 	void paintEvent(QPaintEvent*) override;
 
+	void changeEvent(QEvent* event) override;
+
 public slots:
 
 	void onDataUpdated();
+
+private:
+	// grid, labels, ring outlines and names, redrawn only when one of them changes
+	QPixmap background;
+	QSize backgroundSize;
+	std::string backgroundKey;
+	bool backgroundChanged = true;
+	GraphGeometry geometry;
+	QPolygonF graphVertices;
+
+	void updateBackground(const std::vector<UtilizationData>& utilizationData);
 };
 
 class GPUUtilization : public UtilizationWidget
 {
 public:
-	GPUUtilization();
+	explicit GPUUtilization(GPUUtilizationWorker* worker);
 
 	virtual const char* GetName() const override
 	{ return "GPU use "; };
@@ -104,7 +170,7 @@ public:
 class MemoryUtilization : public UtilizationWidget
 {
 public:
-	MemoryUtilization();
+	explicit MemoryUtilization(MemoryUtilizationWorker* worker);
 
 	virtual const char* GetName() const override
 	{ return "Memory use "; };
@@ -118,10 +184,14 @@ private:
 	std::string max;
 };
 
-void drawGrid(QWidget* widget, QPainter* p, const char* name);
+void drawGrid(const GraphGeometry& geometry, const QFontMetrics& fontMetrics, QPainter* p, const char* name);
+
+// vertices is a buffer reused between frames
+void drawGraph(const GraphGeometry& geometry, const UtilizationView& view, QPainter* p, QPolygonF& vertices);
 
-void drawGraph(UtilizationWorker* worker, QPainter* p);
+void drawStatusOutlines(const GraphGeometry& geometry, const QFontMetrics& fontMetrics, std::vector<QRect>& statusObjectsAreas,
+						const std::vector<UtilizationData>& utilizationData, QPainter* p);
 
-void drawStatusObjects(std::vector<QRect>& statusObjectsAreas, UtilizationData* utilizationData, QPainter* p);
+void drawStatusObjects(const GraphGeometry& geometry, const std::vector<QRect>& statusObjectsAreas, const std::vector<UtilizationData>& utilizationData, QPainter* p);
 
 #endif
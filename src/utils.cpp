@@ -1,28 +1,181 @@
 #include "utils.h"
 
-#include <stdexcept>
 #include <chrono>
 #include <sstream>
+#include <mutex>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <spawn.h>
+#include <unistd.h>
+#include <sys/wait.h>
 
-#define BUFFER_SIZE 256
+#define BUFFER_SIZE 4096
 
-std::string exec(const std::string& cmd) {
+extern char **environ;
+
+using namespace std::chrono;
+
+static std::mutex orphansMutex;
+static std::vector<pid_t> orphans; // killed, but not exited yet
+static std::atomic<unsigned long> spawned {0};
+
+void countSpawn() {
+    spawned++;
+}
+
+unsigned long getSpawnCount() {
+    return spawned;
+}
+
+static void reapOrphans() {
+    std::lock_guard<std::mutex> lock(orphansMutex);
+
+    for (size_t i = 0; i < orphans.size();) {
+        if (waitpid(orphans[i], nullptr, WNOHANG) != 0) {
+            orphans[i] = orphans.back();
+            orphans.pop_back();
+        } else {
+            i++;
+        }
+    }
+}
+
+void reap(const pid_t pid) {
+    reapOrphans();
+
+    steady_clock::time_point deadline = steady_clock::now() + milliseconds(NVSM_EXEC_KILL_GRACE);
+    while (waitpid(pid, nullptr, WNOHANG) == 0) {
+        if (steady_clock::now() >= deadline) {
+            kill(pid, SIGKILL);
+            if (waitpid(pid, nullptr, WNOHANG) == 0) {
+                std::lock_guard<std::mutex> lock(orphansMutex);
+                orphans.push_back(pid);
+            }
+            return;
+        }
+
+        usleep(1000);
+    }
+}
+
+// sh is started in its own process group, so a timeout kills whatever it started too
+ExecResult run(const std::string &cmd, const int timeout) {
+    ExecResult result;
+    reapOrphans();
+
+    // close-on-exec, so children spawned at the same time by other threads do not keep them open
+    int out[2], err[2];
+    if (pipe2(out, O_CLOEXEC) != 0)
+        return result;
+    if (pipe2(err, O_CLOEXEC) != 0) {
+        close(out[0]);
+        close(out[1]);
+        return result;
+    }
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+    posix_spawn_file_actions_adddup2(&actions, out[1], STDOUT_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, err[1], STDERR_FILENO);
+
+    // the headless collector blocks SIGTERM in all its threads
+    sigset_t none;
+    sigemptyset(&none);
+    posix_spawnattr_t attributes;
+    posix_spawnattr_init(&attributes);
+    posix_spawnattr_setflags(&attributes, POSIX_SPAWN_SETPGROUP | POSIX_SPAWN_SETSIGMASK);
+    posix_spawnattr_setpgroup(&attributes, 0);
+    posix_spawnattr_setsigmask(&attributes, &none);
+
+    const char *argv[] = {"sh", "-c", cmd.c_str(), nullptr};
+    pid_t pid;
+    int error = posix_spawn(&pid, "/bin/sh", &actions, &attributes, (char* const*) argv, environ);
+
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attributes);
+    close(out[1]);
+    close(err[1]);
+
+    if (error != 0) {
+        close(out[0]);
+        close(err[0]);
+        result.err = strerror(error);
+        return result;
+    }
+
+    countSpawn();
+
+    steady_clock::time_point deadline = steady_clock::now() + milliseconds(timeout);
+    pollfd fds[2] = {{out[0], POLLIN, 0}, {err[0], POLLIN, 0}};
+    std::string *outputs[2] = {&result.out, &result.err};
+    int open = 2;
     char buffer[BUFFER_SIZE];
-    std::string result;
-    FILE* pipe = popen(cmd.c_str(), "r");
-    if (!pipe) throw std::runtime_error("popen() failed!");
-    try {
-        while (fgets(buffer, sizeof buffer, pipe) != nullptr) {
-            result += buffer;
+
+    while (open > 0) {
+        long remaining = duration_cast<milliseconds>(deadline - steady_clock::now()).count();
+        if (remaining <= 0) {
+            result.timedOut = true;
+            break;
+        }
+
+        if (poll(fds, 2, remaining) < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+
+        for (int i = 0; i < 2; i++) {
+            if (fds[i].fd < 0 || fds[i].revents == 0)
+                continue;
+
+            ssize_t count = read(fds[i].fd, buffer, sizeof buffer);
+            if (count > 0) {
+                if (outputs[i]->size() < NVSM_EXEC_OUTPUT_MAX)
+                    outputs[i]->append(buffer, count);
+            } else if (count == 0 || errno != EINTR) {
+                close(fds[i].fd);
+                fds[i].fd = -1; // poll() skips negative descriptors
+                open--;
+            }
         }
-    } catch (...) {
-        pclose(pipe);
-        throw;
     }
-    pclose(pipe);
+
+    for (pollfd &fd : fds)
+        if (fd.fd >= 0)
+            close(fd.fd);
+
+    // both pipes are closed, but the command may still be running, e.g. with its output redirected
+    int status;
+    pid_t exited;
+    while (!result.timedOut && (exited = waitpid(pid, &status, WNOHANG)) == 0) {
+        if (steady_clock::now() >= deadline)
+            result.timedOut = true;
+        else
+            usleep(1000);
+    }
+
+    if (result.timedOut) {
+        kill(-pid, SIGKILL);
+        reap(pid);
+        return result;
+    }
+
+    if (exited == pid)
+        result.status = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+
     return result;
 }
 
+std::string exec(const std::string& cmd) {
+    ExecResult result = run(cmd);
+    return result.ok() ? result.out : std::string();
+}
+
 // TODO: maybe use regex instead?
 
 Iterator range(const std::string& line, const std::string &key, const size_t& n) {
@@ -41,39 +194,39 @@ Iterator range(const std::string& line, const std::string &key, const size_t& n)
     return it;
 }
 
-std::vector<std::string> split(std::string in, const std::string& delimiter) {
+std::vector<std::string> split(const std::string& in, const std::string& delimiter) {
     std::vector<std::string> out;
-    size_t pos = 0;
-    std::string token;
-    while ((pos = in.find(delimiter)) != std::string::npos) {
-        token = in.substr(0, pos);
-        out.push_back(token);
-        in.erase(0, pos + delimiter.length());
+    size_t begin = 0, pos;
+    while ((pos = in.find(delimiter, begin)) != std::string::npos) {
+        out.emplace_back(in, begin, pos - begin);
+        begin = pos + delimiter.length();
     }
-    out.push_back(in);
+    out.emplace_back(in, begin);
     return out;
 }
 
+// removes leading spaces and squeezes runs of spaces in every line, in one pass
 std::string streamline(const std::string& in) {
-    std::vector<std::string> lines = split(in, "\n");
-
-    Iterator it {};
-    for (std::string &line : lines) {
-        it = range(line, " ");
-        if (it.begin == 0) line.erase(0, it.end);
-        it.end = 0;
-
-        while ((it = range(line, " ", it.end)).begin != std::string::npos) {
-            if ((it.end - it.begin) > 1) {
-                line.erase(it.begin, it.end - it.begin - 1);
-                it.end = 0; // because we call erase
-            }
+    std::string s;
+    s.reserve(in.size() + 1);
+
+    bool lineStart = true, space = false;
+    for (char c : in) {
+        if (c == ' ') {
+            space = !lineStart;
+            continue;
         }
+
+        if (space)
+            s += ' ';
+        space = false;
+        lineStart = c == '\n';
+        s += c;
     }
-    
-    std::string s;
-    for (const std::string &line : lines)
-        s += line + "\n";
+
+    if (space)
+        s += ' ';
+    s += '\n';
 
     return s;
 }
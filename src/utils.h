@@ -3,14 +3,39 @@
 
 #include <string>
 #include <vector>
+#include <sys/types.h>
+
+#include "constants.h"
 
 struct Iterator {
     size_t begin, end;
 };
 
+struct ExecResult {
+    std::string out, err;
+    int status = -1; // exit code, 128 + signal if it was killed, -1 if it could not be started or timed out
+    bool timedOut = false;
+
+    bool ok() const { return status == 0; }
+};
+
+// runs cmd with sh, reading stdout and stderr as they come; after timeout ms
+// its process group is killed, so a hung command never blocks the caller
+ExecResult run(const std::string &cmd, int timeout = NVSM_EXEC_TIMEOUT);
+
+// stdout of run(), empty if it failed
 std::string exec(const std::string &cmd);
+
+// waits up to NVSM_EXEC_KILL_GRACE for a child that was sent a signal, then kills it;
+// one that still does not exit, e.g. stuck in the driver, is reaped by a later call
+void reap(pid_t pid);
+
+// child processes started by run() and by streams, for the sampling statistics
+void countSpawn();
+unsigned long getSpawnCount();
+
 Iterator range(const std::string &line, const std::string &key, const size_t &n = 0);
-std::vector<std::string> split(std::string in, const std::string &delimiter);
+std::vector<std::string> split(const std::string &in, const std::string &delimiter);
 std::string streamline(const std::string &in);
 std::string toString(float val, int n = 1);
 size_t startsWith(const std::vector<std::string> &lines, const std::string &s);
@@ -6,27 +6,164 @@
 #include "constants.h"
 #include "settings.h"
 
+using namespace std::chrono;
+
+class TaskRunnable : public QRunnable {
+public:
+    TaskRunnable(WorkerThread *thread, ScheduledTask *task, const bool pause): thread(thread), task(task), pause(pause) {
+        setAutoDelete(true);
+    }
+
+    void run() override {
+        if (pause)
+            task->paused();
+        else
+            task->job();
+        thread->finished(task);
+    }
+
+private:
+    WorkerThread *thread;
+    ScheduledTask *task;
+    bool pause; // run paused instead of job
+};
+
 Worker::~Worker() {
     std::cout << "Worker " << this << " deleted\n";
 }
 
-WorkerThread::WorkerThread() {
-    workers = new Worker*[NVSM_WORKERS_MAX];
+WorkerThread::WorkerThread(MetricsSource *source) {
+    sampler.source = source;
+}
+
+size_t WorkerThread::addTask(const uint interval, const std::function<void()> &job, const std::function<void()> &paused) {
+    auto *task = new ScheduledTask;
+    task->job = job;
+    task->paused = paused;
+    task->interval = task->fullInterval = milliseconds(interval > 0 ? interval : 1);
+    tasks.push_back(task);
+    pool.setMaxThreadCount(tasks.size());
+
+    return tasks.size() - 1;
 }
 
 void WorkerThread::run() {
+    QMutexLocker locker(&mutex);
+
+    steady_clock::time_point now = steady_clock::now();
+    for (ScheduledTask *task : tasks)
+        task->deadline = task->lastStart = now;
+
     while (running) {
-        for (uint i = 0; i < NVSM_WORKERS_MAX; i++) {
-            workers[i]->work();
+        now = steady_clock::now();
+
+        if (refreshing) {
+            refreshing = false;
+            for (ScheduledTask *task : tasks)
+                if (task->interval.count() > 0)
+                    task->deadline = now;
+        }
+
+        // a task paused while it was running is told once it is done, finished() wakes the loop
+        for (ScheduledTask *task : tasks) {
+            if (task->pausing && !task->busy.exchange(true)) {
+                task->pausing = false;
+                pool.start(new TaskRunnable(this, task, true));
+            }
         }
 
-        usleep(UPDATE_DELAY_USEC);
+        steady_clock::time_point next = steady_clock::time_point::max();
+        for (ScheduledTask *task : tasks)
+            next = std::min(next, task->deadline);
+
+        // no wake-ups between deadlines, none at all while every task is paused;
+        // woken early by stop(), refresh() or setInterval(), the loop checks again
+        if (next == steady_clock::time_point::max()) {
+            wakeUp.wait(&mutex);
+            continue;
+        } else if (next > now) {
+            wakeUp.wait(&mutex, ceil<milliseconds>(next - now).count());
+            continue;
+        }
+
+        for (ScheduledTask *task : tasks) {
+            if (task->deadline > now)
+                continue;
+
+            // a task that is still running from the previous period skips this one;
+            // the skipped periods are counted between deadlines, wake-up latency can not round them down
+            if (!task->busy.exchange(true)) {
+                long periods = (task->deadline - task->lastStart) / task->fullInterval;
+                if (periods > 1)
+                    task->skipped += periods - 1;
+                task->lastStart = task->deadline;
+                task->runs++;
+                pool.start(new TaskRunnable(this, task, false));
+            }
+
+            if (task->interval.count() == 0) {
+                task->deadline = steady_clock::time_point::max();
+                continue;
+            }
+
+            // stay on the original grid instead of drifting by the wake-up latency
+            do {
+                task->deadline += task->interval;
+            } while (task->deadline <= now);
+        }
     }
 
+    locker.unlock();
+    pool.waitForDone();
+
     std::cout << "WorkerThread done all work!\n";
 }
 
+void WorkerThread::stop() {
+    QMutexLocker locker(&mutex);
+    running = false;
+    wakeUp.wakeAll();
+}
+
+void WorkerThread::refresh() {
+    QMutexLocker locker(&mutex);
+    refreshing = true;
+    wakeUp.wakeAll();
+}
+
+void WorkerThread::setInterval(const size_t task, const uint interval) {
+    QMutexLocker locker(&mutex);
+    ScheduledTask *scheduled = tasks[task];
+
+    if (scheduled->interval == milliseconds(interval))
+        return;
+
+    scheduled->interval = milliseconds(interval);
+    scheduled->deadline = interval > 0 ? steady_clock::now() : steady_clock::time_point::max();
+    scheduled->pausing = interval == 0 && scheduled->paused;
+    wakeUp.wakeAll();
+}
+
+// under the mutex, so the loop can not miss a pause that came while the task was running
+void WorkerThread::finished(ScheduledTask *task) {
+    QMutexLocker locker(&mutex);
+    task->busy = false;
+    if (task->pausing)
+        wakeUp.wakeAll();
+}
+
+uint WorkerThread::getInterval(const size_t task) {
+    QMutexLocker locker(&mutex);
+    return tasks[task]->interval.count();
+}
+
+TaskStatistics WorkerThread::getStatistics(const size_t task) const {
+    return {tasks[task]->runs, tasks[task]->skipped};
+}
+
 WorkerThread::~WorkerThread() {
-    delete[] workers;
+    for (ScheduledTask *task : tasks)
+        delete task;
+    delete sampler.source;
     std::cout << "WorkerThread " << this << " deleted\n";
 }
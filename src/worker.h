@@ -3,11 +3,20 @@
 
 #include <QThread>
 #include <QMutex>
+#include <QWaitCondition>
+#include <QThreadPool>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <vector>
+
+#include "sampler.h"
 
 class Worker : public QObject {
     Q_OBJECT
 public:
-    QMutex mutex;
+    QMutex mutex; // between the writers of a worker, e.g. its task and a replay; readers load snapshots
+    GPUSampler *sampler = nullptr; // shared per-tick snapshot, owned by WorkerThread
 
     virtual void work() = 0;
 
@@ -16,15 +25,67 @@ signals:
     void dataUpdated();
 };
 
+struct ScheduledTask {
+    std::function<void()> job;
+    std::function<void()> paused; // run once instead of job when the task is paused, may be empty
+    bool pausing = false; // paused is due, guarded by WorkerThread::mutex
+    std::chrono::milliseconds interval; // 0 - paused
+    std::chrono::milliseconds fullInterval; // the one it was added with
+    std::chrono::steady_clock::time_point deadline;
+    std::chrono::steady_clock::time_point lastStart; // deadline of the last run
+    std::atomic<bool> busy {false};
+    std::atomic<unsigned long> runs {0};
+    std::atomic<unsigned long> skipped {0}; // runs it would have had at fullInterval, but did not
+};
+
+struct TaskStatistics {
+    unsigned long runs, skipped;
+};
+
+/**
+ * Runs every task on its own interval. Deadlines are absolute, so collection
+ * time does not add up to the period, and the tasks run in parallel on a
+ * small thread pool, so a slow one does not delay the others. Between
+ * deadlines the thread sleeps on a wait condition, stop(), refresh() and
+ * setInterval() wake it at once
+ */
 class WorkerThread : public QThread {
 public:
-    bool running = true;
-    Worker **workers;
-    
-    WorkerThread();
+    GPUSampler sampler;
+
+    explicit WorkerThread(MetricsSource *source); // takes ownership of source
     ~WorkerThread() override;
-    
+
+    // must be called before start(), returns the index of the task; paused is run when
+    // setInterval() pauses the task, once the job is not running, e.g. to stop a stream
+    size_t addTask(uint interval, const std::function<void()> &job, const std::function<void()> &paused = nullptr);
+
     void run() override;
+
+    // run() returns once the running tasks are done, wait() for it
+    void stop();
+
+    // runs every task now, except those still busy, and continues on a new grid from here
+    void refresh();
+
+    // 0 pauses the task, the job is not run again until the interval changes. Any other
+    // changed interval runs the task at once, which catches up after a slow period and
+    // lets the job adapt its source to the new rate
+    void setInterval(size_t task, uint interval);
+    uint getInterval(size_t task);
+
+    TaskStatistics getStatistics(size_t task) const;
+
+private:
+    std::vector<ScheduledTask*> tasks;
+    QThreadPool pool;
+    QMutex mutex; // guards the deadlines and intervals
+    QWaitCondition wakeUp;
+    std::atomic<bool> running {true};
+    bool refreshing = false; // guarded by mutex
+
+    friend class TaskRunnable;
+    void finished(ScheduledTask *task);
 };
 
 #endif
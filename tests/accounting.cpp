@@ -0,0 +1,204 @@
+#include "test.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+
+#include "accounting.h"
+#include "processlist.h"
+#include "rowdiff.h"
+
+#define DOCKER "0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef"
+#define KUBERNETES "fedcba9876543210fedcba9876543210fedcba9876543210fedcba9876543210"
+#define UNKNOWN_PID 299 // not in procfs
+
+static std::string root;
+
+static void write(int pid, const std::string &file, const std::string &content) {
+    std::string dir = root + "/" + std::to_string(pid);
+    mkdir(dir.c_str(), 0755);
+    std::ofstream(dir + "/" + file, std::ios::binary) << content;
+}
+
+// a process of root with the given cgroup file, as procfs reads it
+static void writeProcess(int pid, const std::string &cgroup) {
+    write(pid, "stat", std::to_string(pid) + " (python3) S 1 1 1 0 -1 4194304 100 0 0 0 100 50 0 0 20 0 1 0 1000"
+        " 1000000 256 18446744073709551615 0 0 0 0 0 0 0 0 0 0 0 0 17 3 0 0\n");
+    write(pid, "status", "Name:\tpython3\nUid:\t0\t0\t0\t0\n");
+    write(pid, "cgroup", cgroup);
+}
+
+static ProcessSample sample(int GPUIndex, int pid, int sm, int fb) {
+    ProcessSample sample;
+    sample.GPUIndex = GPUIndex;
+    sample.pid = pid;
+    sample.type = "C";
+    sample.sm = sm;
+    sample.fb = fb;
+    return sample;
+}
+
+static std::vector<ProcessList> processes(ProcFS &procfs, const std::vector<ProcessSample> &samples) {
+    std::vector<int> pids;
+    for (const ProcessSample &sample : samples)
+        if (sample.pid != NVSM_NA)
+            pids.push_back(sample.pid);
+    procfs.update(pids);
+
+    std::vector<ProcessList> result;
+    for (const ProcessSample &sample : samples)
+        result.emplace_back(sample, 0, 0, procfs.get(sample.pid));
+    return result;
+}
+
+// nullptr if the group is not in the list
+static const GroupUsage* find(const std::vector<GroupUsage> &groups, const std::string &name) {
+    for (const GroupUsage &group : groups)
+        if (group.name == name)
+            return &group;
+    return nullptr;
+}
+
+static std::string shortId(const char *id) {
+    return std::string(id).substr(0, NVSM_CONTAINER_ID_SHORT);
+}
+
+// the container of a process is the first run of exactly 64 hex digits in its cgroup
+static void testContainerId() {
+    writeProcess(100, "0::/system.slice/docker-" DOCKER ".scope\n");
+    writeProcess(101, "12:memory:/kubepods/burstable/pod0a1b2c3d-0000-1111-2222-333344445555/" KUBERNETES "\n"
+                      "11:cpu,cpuacct:/kubepods/burstable/pod0a1b2c3d-0000-1111-2222-333344445555/" KUBERNETES "\n");
+    writeProcess(102, "12:memory:/docker/" KUBERNETES "\n0::/system.slice/cri-containerd-" DOCKER ".scope\n");
+    writeProcess(103, "0::/user.slice/user-1000.slice/session-2.scope\n");
+    writeProcess(104, std::string("0::/machine.slice/") + DOCKER "0.scope\n"); // 65 digits
+    writeProcess(105, std::string("0::/machine.slice/") + (DOCKER + 1) + ".scope\n"); // 63 digits
+    writeProcess(106, "");
+
+    ProcFS procfs(root);
+    Accounting accounting;
+    accounting.update(processes(procfs, {sample(0, 100, 0, 0), sample(0, 101, 0, 0), sample(0, 102, 0, 0),
+                                         sample(0, 103, 0, 0), sample(0, 104, 0, 0), sample(0, 105, 0, 0),
+                                         sample(0, 106, 0, 0)}), 1000);
+
+    auto container = [&](int pid) { return procfs.get(pid).identity->container; };
+    assert(container(100) == shortId(DOCKER));
+    assert(container(101) == shortId(KUBERNETES));
+    assert(container(102) == shortId(DOCKER)); // the unified hierarchy wins
+    assert(container(103).empty() && container(104).empty() && container(105).empty() && container(106).empty());
+
+    std::vector<GroupUsage> groups = accounting.get(ByContainer).active;
+    assert(groups.size() == 3);
+    assert(find(groups, shortId(DOCKER))->processes == 2);
+    assert(find(groups, shortId(KUBERNETES))->processes == 1);
+    assert(find(groups, "(host)")->processes == 4);
+
+    groups = accounting.get(ByCgroup).active;
+    assert(find(groups, "/system.slice/docker-" DOCKER ".scope")->processes == 1);
+    assert(find(groups, "(unknown)")->processes == 1); // no cgroup at all
+}
+
+// totals follow the processes as they are added, change and exit; a process without a pid is not counted
+static void testTotals() {
+    writeProcess(200, "0::/system.slice/docker-" DOCKER ".scope\n");
+    writeProcess(201, "0::/kubepods/" KUBERNETES "\n");
+    writeProcess(202, "0::/user.slice/user-1000.slice/session-2.scope\n");
+
+    ProcFS procfs(root);
+    Accounting accounting;
+
+    // 200 uses two GPUs and counts on both, pmon prints a row without a pid for an idle GPU
+    accounting.update(processes(procfs, {sample(0, 200, 50, 1000), sample(1, 200, 30, 500), sample(0, 201, 20, 100),
+                                         sample(0, UNKNOWN_PID, 10, 10), sample(2, NVSM_NA, 90, 9000)}), 1000);
+
+    GroupsData containers = accounting.get(ByContainer);
+    assert(containers.active.size() == 3 && containers.idle->empty());
+    const GroupUsage *docker = find(containers.active, shortId(DOCKER));
+    assert(docker->processes == 2 && docker->computeUse == 80 && docker->vRAM == 1500);
+    assert(docker->GPUSeconds == 0); // nothing to integrate over yet
+    assert(find(containers.active, shortId(KUBERNETES))->computeUse == 20);
+    assert(find(containers.active, "(unknown)")->processes == 1);
+
+    std::vector<GroupUsage> users = accounting.get(ByUser).active;
+    assert(users.size() == 2 && find(users, "(unknown)")->vRAM == 10);
+
+    // 200 changes and leaves GPU 1, 201 exits, 202 starts
+    accounting.update(processes(procfs, {sample(0, 200, 10, 2000), sample(0, 202, 40, 300)}), 3000);
+
+    containers = accounting.get(ByContainer);
+    assert(containers.active.size() == 2);
+    docker = find(containers.active, shortId(DOCKER));
+    assert(docker->processes == 1 && docker->computeUse == 10 && docker->vRAM == 2000);
+    assert(std::fabs(docker->GPUSeconds - 0.2) < 1e-9); // 10 % for 2 s
+    assert(docker->lastActive == 3000);
+    assert(find(containers.active, "(host)")->computeUse == 40);
+
+    // the groups without processes keep their GPU-seconds and the time they were last active
+    assert(containers.idle->size() == 2);
+    const GroupUsage *kubernetes = find(*containers.idle, shortId(KUBERNETES));
+    assert(kubernetes->processes == 0 && kubernetes->computeUse == 0 && kubernetes->vRAM == 0);
+    assert(kubernetes->lastActive == 1000);
+
+    // everything exits
+    accounting.update(processes(procfs, {}), 4000);
+    containers = accounting.get(ByContainer);
+    assert(containers.active.empty() && containers.idle->size() == 4);
+    for (const GroupUsage &group : *containers.idle)
+        assert(group.processes == 0 && group.computeUse == 0 && group.vRAM == 0);
+    assert(std::fabs(find(*containers.idle, shortId(DOCKER))->GPUSeconds - 0.2) < 1e-9);
+
+    // rows without a pid alone make no group
+    Accounting idle;
+    idle.update(processes(procfs, {sample(0, NVSM_NA, 90, 9000), sample(1, NVSM_NA, 0, 0)}), 1000);
+    for (int by = 0; by < NVSM_GROUP_MODES; by++)
+        assert(idle.get((GroupBy) by).active.empty() && idle.get((GroupBy) by).idle->empty());
+}
+
+// counts the rows diffRows() reports
+struct Changes {
+    int removedRows = 0, changedRows = 0, insertedRows = 0;
+
+    void beginRemove(size_t first, size_t last) { removedRows += last - first + 1; }
+    void endRemove(size_t, size_t) {}
+    void kept(size_t, size_t, bool changed) { changedRows += changed; }
+    void beginInsert(size_t, size_t) {}
+    void inserted(size_t, size_t) { insertedRows++; }
+    void endInsert() {}
+};
+
+// the accounting table is diffed by group name, a group whose shown values did not change is not repainted
+static void testRows() {
+    std::vector<GroupUsage> rows, incoming(3);
+    incoming[0].name = "root";
+    incoming[1].name = "alice";
+    incoming[2].name = "bob";
+
+    Changes changes;
+    assert(diffRows(rows, incoming, changes));
+    assert(changes.insertedRows == 3);
+
+    incoming[0].lastActive = 5000;
+    incoming[1].GPUSeconds = 1.5;
+    incoming.erase(incoming.begin() + 2);
+
+    changes = Changes();
+    assert(diffRows(rows, incoming, changes));
+    assert(changes.removedRows == 1 && changes.changedRows == 1 && changes.insertedRows == 0);
+    assert(rows.size() == 2 && rows[1].GPUSeconds == 1.5);
+}
+
+int main() {
+    char dir[] = "/tmp/nvsm-accounting-XXXXXX";
+    assert(mkdtemp(dir));
+    root = dir;
+
+    testContainerId();
+    testTotals();
+    testRows();
+
+    system(("rm -rf " + root).c_str());
+
+    return 0;
+}
@@ -0,0 +1,212 @@
+#include "test.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+
+#include "alerts.h"
+#include "parser.h"
+
+// what the handler was given, the rule only lives while it runs
+struct Fired {
+    std::string rule;
+    int GPU;
+    double value;
+    bool firing;
+};
+
+static std::vector<Fired> fired;
+
+static void record(const AlertEvent &event) {
+    fired.push_back({event.rule->name, event.GPU, event.value, event.firing});
+}
+
+static GPUSample gpu(const std::string &uuid, int utilization, int memoryUsed = 0, int memoryTotal = 1000) {
+    GPUSample sample;
+    sample.uuid = uuid;
+    sample.name = "A100";
+    sample.utilization = utilization;
+    sample.memoryUsed = memoryUsed;
+    sample.memoryTotal = memoryTotal;
+    return sample;
+}
+
+static void testParse() {
+    AlertEngine alerts(record);
+    assert(alerts.empty());
+
+    assert(alerts.add("alert hot utilization > 90 and memory >= 50 for 3000 hysteresis 5 log"));
+    assert(!alerts.needsProcesses());
+    assert(alerts.add("alert busy processes > 4 notify"));
+    assert(alerts.needsProcesses());
+    assert(alerts.add("alert hook utilization <= 0 exec logger \"{rule} {state}\"  on {gpu}"));
+
+    assert(!alerts.add("alert hot utilization > 90 and"));
+    assert(!alerts.add("alert hot temperature > 90 log"));
+    assert(!alerts.add("alert hot utilization => 90 log"));
+    assert(!alerts.add("alert hot utilization > 90 page"));
+    assert(!alerts.add("alert hot utilization"));
+    assert(!alerts.empty());
+}
+
+// the conditions must hold for the whole duration, checked on every sample
+static void testDuration() {
+    AlertEngine alerts(record);
+    assert(alerts.add("alert hot utilization > 90 for 3000 log"));
+    fired.clear();
+
+    alerts.evaluate(0, {gpu("GPU-a", 95), gpu("GPU-b", 10)}, {});
+    alerts.evaluate(2000, {gpu("GPU-a", 95), gpu("GPU-b", 10)}, {});
+    assert(fired.empty());
+
+    alerts.evaluate(3000, {gpu("GPU-a", 95), gpu("GPU-b", 10)}, {});
+    assert(fired.size() == 1);
+    assert(fired[0].rule == "hot" && fired[0].GPU == 0 && fired[0].value == 95 && fired[0].firing);
+
+    // once, not on every sample while it fires
+    alerts.evaluate(4000, {gpu("GPU-a", 99), gpu("GPU-b", 10)}, {});
+    assert(fired.size() == 1);
+
+    // the state follows the GPU, not its index
+    alerts.evaluate(5000, {gpu("GPU-b", 10), gpu("GPU-a", 99)}, {});
+    assert(fired.size() == 1);
+}
+
+// a sample that breaks the condition starts the duration over
+static void testReset() {
+    AlertEngine alerts(record);
+    assert(alerts.add("alert hot utilization > 90 for 3000 log"));
+    fired.clear();
+
+    alerts.evaluate(0, {gpu("GPU-a", 95)}, {});
+    alerts.evaluate(2000, {gpu("GPU-a", 50)}, {});
+    alerts.evaluate(4000, {gpu("GPU-a", 95)}, {});
+    alerts.evaluate(6000, {gpu("GPU-a", 95)}, {});
+    assert(fired.empty());
+
+    alerts.evaluate(7000, {gpu("GPU-a", 95)}, {});
+    assert(fired.size() == 1 && fired[0].firing);
+}
+
+// a firing alert resolves only once the value is past the threshold by the hysteresis
+static void testHysteresis() {
+    AlertEngine alerts(record);
+    assert(alerts.add("alert full memory > 90 hysteresis 5 log"));
+    fired.clear();
+
+    alerts.evaluate(0, {gpu("GPU-a", 0, 950)}, {});
+    assert(fired.size() == 1 && fired[0].firing && fired[0].value == 95);
+
+    alerts.evaluate(1000, {gpu("GPU-a", 0, 880)}, {});
+    alerts.evaluate(2000, {gpu("GPU-a", 0, 850)}, {});
+    alerts.evaluate(3000, {gpu("GPU-a", 0, 920)}, {});
+    assert(fired.size() == 1);
+
+    alerts.evaluate(4000, {gpu("GPU-a", 0, 840)}, {});
+    assert(fired.size() == 2 && !fired[1].firing && fired[1].value == 84);
+
+    // and fires again when the condition holds again
+    alerts.evaluate(5000, {gpu("GPU-a", 0, 910)}, {});
+    assert(fired.size() == 3 && fired[2].firing);
+}
+
+// a value the source does not report neither holds a condition nor resolves an alert
+static void testNA() {
+    AlertEngine alerts(record);
+    assert(alerts.add("alert idle utilization < 5 for 1000 log"));
+    assert(alerts.add("alert crowded processes > 2 log"));
+    fired.clear();
+
+    alerts.evaluate(0, {gpu("GPU-a", NVSM_NA)}, {NVSM_NA});
+    alerts.evaluate(2000, {gpu("GPU-a", NVSM_NA)}, {NVSM_NA});
+    assert(fired.empty());
+
+    // pending since the first known value
+    alerts.evaluate(3000, {gpu("GPU-a", 0)}, {3});
+    assert(fired.size() == 1 && fired[0].rule == "crowded" && fired[0].value == 3);
+    alerts.evaluate(3500, {gpu("GPU-a", NVSM_NA)}, {NVSM_NA});
+    alerts.evaluate(4000, {gpu("GPU-a", 0)}, {NVSM_NA});
+    assert(fired.size() == 1);
+
+    // an unknown value while firing keeps the alerts firing, a missing count is unknown too
+    alerts.evaluate(5000, {gpu("GPU-a", 0)}, {3});
+    assert(fired.size() == 2 && fired[1].rule == "idle" && fired[1].firing);
+    alerts.evaluate(6000, {gpu("GPU-a", NVSM_NA)}, {});
+    assert(fired.size() == 2);
+
+    alerts.evaluate(7000, {gpu("GPU-a", 50)}, {0});
+    assert(fired.size() == 4 && !fired[2].firing && !fired[3].firing);
+}
+
+// the idle GPU of a pmon dump has a row without a pid, it is not a process
+static void testCountProcesses() {
+    std::istringstream dump(
+        "# gpu         pid   type     fb     sm    mem    enc    dec    command\n"
+        "# Idx           #    C/G     MB      %      %      %      %    name\n"
+        "    0       1234     C    900     50     10      -      -    python3\n"
+        "    0       1235     G    100      5      1      -      -    Xorg\n"
+        "    1          -      -      -      -      -      -      -    -\n"
+        "    5       4321     C    100      5      1      -      -    lost\n");
+
+    std::vector<ProcessSample> processes;
+    std::string line;
+    while (std::getline(dump, line)) {
+        ProcessSample process;
+        if (parsePmonLine(line, process))
+            processes.push_back(process);
+    }
+    assert(processes.size() == 4);
+
+    std::vector<int> counts = countProcesses(processes, 2);
+    assert(counts.size() == 2 && counts[0] == 2 && counts[1] == 0);
+}
+
+// values reach an exec command through its environment, the shell never parses them
+static void testCommand() {
+    AlertEngine alerts([](const AlertEvent &event) {
+        assert(event.command() == "printf '%s|%s|%s|%s|%s' \"${NVSM_ALERT_RULE}\" \"${NVSM_GPU_INDEX}\" "
+                                  "\"${NVSM_GPU_NAME}\" \"${NVSM_ALERT_VALUE}\" \"${NVSM_ALERT_STATE}\" > \"$OUT\"");
+        assert(event.message() == "hot firing on GPU 1 (" + event.gpuName + "): utilization 95.0 %");
+
+        for (const auto &variable : event.environment())
+            setenv(variable.first.c_str(), variable.second.c_str(), 1);
+        assert(system(event.command().c_str()) == 0);
+        fired.push_back({event.rule->name, event.GPU, event.value, event.firing});
+    });
+    assert(alerts.add("alert hot utilization > 90 exec printf '%s|%s|%s|%s|%s' \"{rule}\" \"{gpu}\" \"{name}\" \"{value}\" "
+                      "\"{state}\" > \"$OUT\""));
+    fired.clear();
+
+    char dir[] = "/tmp/nvsm-alerts-XXXXXX";
+    assert(mkdtemp(dir));
+    std::string out = std::string(dir) + "/out", injected = std::string(dir) + "/injected";
+    setenv("OUT", out.c_str(), 1);
+
+    // a GPU name is whatever the driver or a fleet host reports
+    GPUSample evil = gpu("GPU-b", 95);
+    evil.name = "T4\"; touch " + injected + "; echo \"$(touch " + injected + ")`touch " + injected + "`'";
+    alerts.evaluate(0, {gpu("GPU-a", 0), evil}, {});
+    assert(fired.size() == 1);
+
+    std::ifstream file(out);
+    std::string written((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    assert(written == "hot|1|" + evil.name + "|95.0|firing");
+    assert(access(injected.c_str(), F_OK) != 0);
+
+    unlink(out.c_str());
+    rmdir(dir);
+}
+
+int main() {
+    testParse();
+    testDuration();
+    testReset();
+    testHysteresis();
+    testNA();
+    testCountProcesses();
+    testCommand();
+    return 0;
+}
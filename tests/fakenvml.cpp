@@ -0,0 +1,129 @@
+// stand-in for libnvidia-ml, with the symbols NVMLSource resolves; the test sets fakeNvml
+
+#include <cstring>
+
+typedef int nvmlReturn_t;
+typedef struct FakeDevice *nvmlDevice_t;
+
+#define NVML_SUCCESS 0
+#define NVML_ERROR_INVALID_ARGUMENT 2
+#define NVML_ERROR_NOT_FOUND 6
+#define NVML_ERROR_INSUFFICIENT_SIZE 7
+
+#define FAKE_GPUS 2
+#define FAKE_PROCESSES 4
+
+struct FakeProcess {
+    unsigned int pid;
+    unsigned long long usedGpuMemory;
+    unsigned int gpuInstanceId, computeInstanceId;
+};
+
+struct FakeUtilization {
+    unsigned int pid;
+    unsigned long long timeStamp;
+    unsigned int smUtil, memUtil, encUtil, decUtil;
+};
+
+struct FakeDevice {
+    char name[64], uuid[64];
+    unsigned int gpu, memory;
+    unsigned long long total, free, used;
+    unsigned int computeCount, graphicsCount, utilizationCount;
+    FakeProcess compute[FAKE_PROCESSES], graphics[FAKE_PROCESSES];
+    FakeUtilization utilization[FAKE_PROCESSES];
+};
+
+extern "C" {
+
+struct {
+    unsigned int count;
+    FakeDevice devices[FAKE_GPUS];
+    int nameCalls;
+    unsigned long long lastSeen; // as passed to the last nvmlDeviceGetProcessUtilization
+} fakeNvml;
+
+nvmlReturn_t nvmlInit_v2() { return NVML_SUCCESS; }
+nvmlReturn_t nvmlShutdown() { return NVML_SUCCESS; }
+
+nvmlReturn_t nvmlDeviceGetCount_v2(unsigned int *count) {
+    *count = fakeNvml.count;
+    return NVML_SUCCESS;
+}
+
+nvmlReturn_t nvmlDeviceGetHandleByIndex_v2(unsigned int index, nvmlDevice_t *device) {
+    if (index >= fakeNvml.count)
+        return NVML_ERROR_INVALID_ARGUMENT;
+    *device = &fakeNvml.devices[index];
+    return NVML_SUCCESS;
+}
+
+nvmlReturn_t nvmlDeviceGetName(nvmlDevice_t device, char *name, unsigned int length) {
+    fakeNvml.nameCalls++;
+    strncpy(name, device->name, length);
+    return NVML_SUCCESS;
+}
+
+nvmlReturn_t nvmlDeviceGetUUID(nvmlDevice_t device, char *uuid, unsigned int length) {
+    strncpy(uuid, device->uuid, length);
+    return NVML_SUCCESS;
+}
+
+nvmlReturn_t nvmlDeviceGetUtilizationRates(nvmlDevice_t device, unsigned int *utilization) {
+    utilization[0] = device->gpu;
+    utilization[1] = device->memory;
+    return NVML_SUCCESS;
+}
+
+nvmlReturn_t nvmlDeviceGetMemoryInfo(nvmlDevice_t device, unsigned long long *memory) {
+    memory[0] = device->total;
+    memory[1] = device->free;
+    memory[2] = device->used;
+    return NVML_SUCCESS;
+}
+
+static nvmlReturn_t processes(const FakeProcess *from, unsigned int count, unsigned int *size, FakeProcess *to) {
+    if (*size < count) {
+        *size = count;
+        return NVML_ERROR_INSUFFICIENT_SIZE;
+    }
+    memcpy(to, from, count * sizeof *from);
+    *size = count;
+    return NVML_SUCCESS;
+}
+
+nvmlReturn_t nvmlDeviceGetComputeRunningProcesses_v3(nvmlDevice_t device, unsigned int *size, FakeProcess *infos) {
+    return processes(device->compute, device->computeCount, size, infos);
+}
+
+nvmlReturn_t nvmlDeviceGetGraphicsRunningProcesses_v3(nvmlDevice_t device, unsigned int *size, FakeProcess *infos) {
+    return processes(device->graphics, device->graphicsCount, size, infos);
+}
+
+// like NVML, only the samples newer than lastSeen
+nvmlReturn_t nvmlDeviceGetProcessUtilization(nvmlDevice_t device, FakeUtilization *samples, unsigned int *size,
+                                             unsigned long long lastSeen)
+{
+    fakeNvml.lastSeen = lastSeen;
+
+    unsigned int count = 0;
+    for (unsigned int i = 0; i < device->utilizationCount; i++)
+        if (device->utilization[i].timeStamp > lastSeen)
+            count++;
+
+    if (count == 0)
+        return NVML_ERROR_NOT_FOUND;
+    if (*size < count) {
+        *size = count;
+        return NVML_ERROR_INSUFFICIENT_SIZE;
+    }
+
+    *size = 0;
+    for (unsigned int i = 0; i < device->utilizationCount; i++)
+        if (device->utilization[i].timeStamp > lastSeen)
+            samples[(*size)++] = device->utilization[i];
+
+    return NVML_SUCCESS;
+}
+
+}
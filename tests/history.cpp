@@ -0,0 +1,59 @@
+#include "test.h"
+
+#include "history.h"
+
+static void testBuckets() {
+    HistoryTier tier;
+    tier.setup(1000, 4);
+
+    // 0 - 999 and 1000 - 1999
+    tier.add(0, 10);
+    tier.add(400, 30);
+    tier.add(999, 20);
+    tier.add(1000, 50);
+
+    assert(tier.buckets.size() == 2);
+    const Bucket &first = tier.buckets[0];
+    assert(first.time == 0 && first.count == 3);
+    assert(first.min == 10 && first.max == 30 && first.average() == 20);
+    assert(tier.buckets[1].time == 1000 && tier.buckets[1].average() == 50);
+
+    // a gap leaves no empty buckets in between
+    tier.add(5500, 70);
+    assert(tier.buckets.size() == 3 && tier.buckets.back().time == 5000);
+}
+
+// bounded however long it runs, the oldest buckets go first
+static void testBounded() {
+    HistoryTier tier;
+    tier.setup(100, 8);
+
+    for (long time = 0; time < 100000; time += 10)
+        tier.add(time, (int) (time / 100 % 101));
+
+    assert(tier.buckets.size() == 8);
+    assert(tier.buckets.front().time == 99200 && tier.buckets.back().time == 99900);
+    for (size_t i = 0; i < tier.buckets.size(); i++)
+        assert(tier.buckets[i].count == 10);
+
+    tier.clear();
+    assert(tier.buckets.empty() && tier.buckets.capacity() == 8);
+}
+
+static void testCovers() {
+    HistoryTier tier;
+    tier.setup(1000, 62);
+
+    // a partial bucket at each end
+    assert(tier.covers(60000));
+    assert(!tier.covers(61000));
+    Bucket empty {0, 0, 0, 0, 0};
+    assert(empty.average() == 0);
+}
+
+int main() {
+    testBuckets();
+    testBounded();
+    testCovers();
+    return 0;
+}
@@ -0,0 +1,36 @@
+#include "test.h"
+
+#include "hostpoll.h"
+
+static void testOk() {
+    HostSample sample = pollHost("echo '0, {host} GPU, 42, 7, 24576, 12288, 12288'; echo '1, {host}, 0, 0, 100, 100, 0'",
+                                 "node1", 1000);
+
+    assert(sample.ok && sample.error.empty() && sample.time > 0);
+    assert(sample.host == "node1" && sample.gpus.size() == 2);
+    assert(sample.gpus[0].name == "node1 GPU" && sample.gpus[0].utilization == 42);
+    assert(sample.gpus[0].memoryTotal == 24576 && sample.gpus[0].memoryUsed == 12288);
+    assert(sample.gpus[1].name == "node1");
+}
+
+// the error says why, with the first line of stderr
+static void testErrors() {
+    HostSample sample = pollHost("echo 'ssh: connect to host {host}: refused' >&2; echo more >&2; exit 255", "node2", 1000);
+    assert(!sample.ok && sample.gpus.empty() && sample.time == 0);
+    assert(sample.error == "exit code 255: ssh: connect to host node2: refused");
+
+    sample = pollHost("exit 1", "node2", 1000);
+    assert(sample.error == "exit code 1");
+
+    sample = pollHost("echo 'No devices were found'", "node2", 1000);
+    assert(!sample.ok && sample.error == "no GPUs in the output");
+
+    sample = pollHost("sleep 10", "node2", 100);
+    assert(!sample.ok && sample.error == "timed out after 100 ms");
+}
+
+int main() {
+    testOk();
+    testErrors();
+    return 0;
+}
@@ -0,0 +1,59 @@
+#include "test.h"
+
+#include <string>
+
+#include "constants.h"
+#include "metrics.h"
+
+static bool contains(const std::string &text, const std::string &line) {
+    return text.find(line + "\n") != std::string::npos;
+}
+
+static void testGPUs() {
+    std::vector<GPUMetrics> gpus(2);
+    gpus[0].name = "Tesla T4";
+    gpus[0].utilization = 42;
+    gpus[0].memoryUsed = 1024;
+    gpus[0].memoryFree = 14336;
+    gpus[0].memoryTotal = 15360;
+    gpus[1].name = "A100"; // the memory worker has not seen it yet
+
+    std::string out = renderMetrics(gpus, {});
+
+    assert(contains(out, "# TYPE nvsm_gpu_utilization_percent gauge"));
+    assert(contains(out, "nvsm_gpu_utilization_percent{gpu=\"0\",name=\"Tesla T4\"} 42"));
+    assert(contains(out, "nvsm_gpu_memory_used_bytes{gpu=\"0\",name=\"Tesla T4\"} 1073741824"));
+    assert(contains(out, "nvsm_gpu_memory_total_bytes{gpu=\"0\",name=\"Tesla T4\"} 16106127360"));
+    assert(out.find("gpu=\"1\"") == std::string::npos);
+}
+
+static void testProcesses() {
+    ProcessSample process;
+    process.GPUIndex = 1;
+    process.pid = 4242;
+    process.type = "C";
+    process.name = "a \"b\"\\c\nd";
+    process.sm = 17;
+    process.fb = 2;
+
+    ProcessSample idle; // an idle GPU in pmon
+    idle.pid = NVSM_NA;
+    idle.sm = 0;
+
+    std::string out = renderMetrics({}, {process, idle});
+
+    // label values are escaped
+    std::string labels = "{gpu=\"1\",pid=\"4242\",name=\"a \\\"b\\\"\\\\c\\nd\",type=\"C\"} ";
+    assert(contains(out, "nvsm_process_sm_utilization_percent" + labels + "17"));
+    assert(contains(out, "nvsm_process_fb_used_bytes" + labels + "2097152"));
+
+    // mem is not reported, the idle row has no process
+    assert(out.find("nvsm_process_memory_utilization_percent{") == std::string::npos);
+    assert(out.find("pid=\"-1\"") == std::string::npos);
+}
+
+int main() {
+    testGPUs();
+    testProcesses();
+    return 0;
+}
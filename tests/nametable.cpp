@@ -0,0 +1,100 @@
+#include "test.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "nametable.h"
+
+static void testIntern() {
+    NameTable table;
+    assert(table.load()->strings.empty());
+
+    uint32_t python = table.intern("python", 0);
+    uint32_t blender = table.intern("blender", 0);
+    assert(python != blender);
+    assert(table.intern("python", 1) == python);
+
+    // nothing is visible before it is published
+    assert(table.load()->get(python).empty());
+
+    table.publish();
+    std::shared_ptr<const NameTable::Names> names = table.load();
+    assert(names->get(python) == "python" && names->get(blender) == "blender");
+    assert(names->strings.size() == 2);
+
+    // nothing changed, readers keep sharing the same table
+    table.intern("python", 2);
+    table.publish();
+    assert(table.load() == names);
+}
+
+static void testExpire() {
+    NameTable table;
+    uint32_t python = table.intern("python", 0);
+    uint32_t blender = table.intern("blender", 0);
+    table.publish();
+    std::shared_ptr<const NameTable::Names> old = table.load();
+
+    table.intern("python", 100);
+    table.expire(50);
+    table.publish();
+
+    std::shared_ptr<const NameTable::Names> names = table.load();
+    assert(names->get(python) == "python");
+    assert(names->get(blender).empty() && names->strings.size() == 1);
+
+    // a reader still holding the old table still resolves the dropped name
+    assert(old->get(blender) == "blender");
+
+    // a dropped name comes back with a new id, an old id never means another name
+    uint32_t again = table.intern("blender", 200);
+    assert(again != blender && again != python);
+    table.publish();
+    assert(table.load()->get(again) == "blender" && table.load()->get(blender).empty());
+}
+
+// readers resolve ids while the writer interns, expires and publishes; every table a reader
+// loads must be complete and never change under it
+static void testConcurrent() {
+    NameTable table;
+    std::atomic<bool> done(false);
+    std::atomic<long> loads(0);
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; i++) {
+        readers.emplace_back([&] {
+            while (!done.load()) {
+                std::shared_ptr<const NameTable::Names> names = table.load();
+                for (const auto &entry : names->strings) {
+                    const std::string &name = names->get(entry.first);
+                    assert(&name == &entry.second);
+                    assert(name == "process " + std::to_string(std::stoul(name.substr(8))));
+                }
+                loads++;
+            }
+        });
+    }
+
+    for (long time = 0; time < 2000; time++) {
+        for (long i = time; i < time + 20; i++)
+            table.intern("process " + std::to_string(i), time);
+        table.expire(time - 5);
+        table.publish();
+
+        assert(table.load()->strings.size() <= 20 + 5);
+    }
+
+    done = true;
+    for (std::thread &reader : readers)
+        reader.join();
+
+    assert(loads > 0);
+}
+
+int main() {
+    testIntern();
+    testExpire();
+    testConcurrent();
+    return 0;
+}
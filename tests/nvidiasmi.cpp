@@ -0,0 +1,208 @@
+#include "test.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "nvidiasmi.h"
+#include "sampler.h"
+#include "settings.h"
+#include "utils.h"
+
+#define WAIT_MAX 3000 // ms
+
+// a stub nvidia-smi first on PATH, it logs every invocation to calls
+static std::string dir;
+
+static void writeStub(const std::string &script) {
+    std::string path = dir + "/nvidia-smi";
+    std::ofstream(path) << "#!/bin/sh\necho \"$*\" >> '" << dir << "/calls'\n" << script;
+    chmod(path.c_str(), 0755);
+}
+
+// the invocations so far, one per line
+static std::vector<std::string> calls() {
+    std::vector<std::string> lines;
+    std::ifstream in(dir + "/calls");
+    for (std::string line; std::getline(in, line);)
+        lines.push_back(line);
+    return lines;
+}
+
+static void clearCalls() {
+    std::ofstream(dir + "/calls", std::ios::trunc);
+}
+
+static void testQuery() {
+    STREAMING = false;
+    writeStub(
+        "case \"$*\" in\n"
+        "*--query-gpu*) echo '0, Fake A100, 10, 20, 40960, 40000, 960, GPU-a'\n"
+        "               echo '1, Fake T4, 30, 40, 15360, 15000, 360, GPU-b' ;;\n"
+        "*pmon*) echo '# gpu         pid   type     fb     sm    mem    enc    dec    command'\n"
+        "        echo '# Idx           #    C/G     MB      %      %      %      %    name'\n"
+        "        echo '    0       1234     C    900     50     10      -      -    python3'\n"
+        "        echo '    1          -      -      -      -      -      -      -    -' ;;\n"
+        "esac\n");
+    clearCalls();
+
+    NvidiaSmiSource source;
+    GPUSampler sampler;
+    sampler.source = &source;
+
+    // one query per tick, for all GPUs and all values
+    for (size_t i = 1; i <= 3; i++) {
+        unsigned long spawned = getSpawnCount();
+        sampler.sample();
+        assert(!sampler.stale);
+        assert(getSpawnCount() == spawned + 1);
+
+        std::vector<std::string> lines = calls();
+        assert(lines.size() == i);
+        assert("nvidia-smi " + lines.back() == NVSMI_CMD_GPU_QUERY);
+    }
+
+    const std::vector<GPUSample> &gpus = sampler.gpus;
+    assert(gpus.size() == 2);
+    assert(gpus[0].name == "Fake A100" && gpus[0].utilization == 10 && gpus[0].uuid == "GPU-a");
+    assert(gpus[1].memoryTotal == 15360 && gpus[1].memoryUsed == 360);
+
+    std::vector<ProcessSample> processes;
+    assert(source.sampleProcesses(processes));
+    assert(calls().size() == 4 && "nvidia-smi " + calls().back() == NVSMI_CMD_PROCESSES);
+
+    // the idle GPU has a placeholder row without a pid
+    assert(processes.size() == 2);
+    assert(processes[0].pid == 1234 && processes[0].name == "python3" && processes[0].sm == 50 && processes[0].fb == 900);
+    assert(processes[1].GPUIndex == 1 && processes[1].pid == NVSM_NA && processes[1].sm == NVSM_NA);
+}
+
+static void testQueryFailure() {
+    STREAMING = false;
+    writeStub("echo 'NVIDIA-SMI has failed' >&2\nexit 9\n");
+    clearCalls();
+
+    NvidiaSmiSource source;
+    std::vector<GPUSample> gpus;
+    assert(!source.sampleGPUs(gpus));
+    assert(calls().size() == 1);
+
+    std::vector<ProcessSample> processes;
+    assert(!source.sampleProcesses(processes));
+}
+
+// streaming: polls until done() or WAIT_MAX, returns done()
+template<typename F>
+static bool pollUntil(F &&done) {
+    long begin = getTime();
+    while (!done()) {
+        if (getTime() - begin > WAIT_MAX)
+            return false;
+        usleep(10000);
+    }
+    return true;
+}
+
+// every loop of --loop-ms prints all GPUs in index order; a GPU that is no longer printed is gone
+static void testStreamLoops() {
+    STREAMING = true;
+    UPDATE_DELAY = 100;
+    writeStub(
+        "i=0\n"
+        "while true; do\n"
+        "  i=$((i + 1))\n"
+        "  echo \"0, Fake A100, $i, 0, 40960, 40000, 960, GPU-a\"\n"
+        "  [ $i -le 3 ] && echo \"1, Fake T4, $i, 0, 15360, 15000, 360, GPU-b\"\n"
+        "  sleep 0.05\n"
+        "done\n");
+    clearCalls();
+
+    NvidiaSmiSource source;
+    std::vector<GPUSample> gpus;
+
+    assert(pollUntil([&] { return source.sampleGPUs(gpus) && gpus.size() == 2; }));
+    assert(pollUntil([&] { source.sampleGPUs(gpus); return gpus.size() == 1; }));
+    assert(gpus[0].uuid == "GPU-a" && gpus[0].utilization >= 4);
+
+    // one nvidia-smi for all of it
+    assert(calls().size() == 1);
+    assert("nvidia-smi " + calls()[0] == NVSMI_CMD_GPU_QUERY_STREAM "100");
+}
+
+// `pmon -o T` lines of one sample share the time column, a sample is complete when it changes
+static void testStreamPmon() {
+    STREAMING = true;
+    PROCESSES_DELAY = 1000;
+    writeStub(
+        "echo '#Time        gpu         pid   type     fb     sm    mem    enc    dec    command'\n"
+        "echo '#HH:MM:SS    Idx           #    C/G     MB      %      %      %      %    name'\n"
+        "echo '10:00:00       0        100     C    900     50     10      -      -    train'\n"
+        "echo '10:00:00       1        200     G    100      5      1      -      -    Xorg'\n"
+        "sleep 0.2\n"
+        "echo '10:00:01       0        100     C    900     60     10      -      -    train'\n"
+        "sleep 0.2\n"
+        "echo '10:00:02       0          -     -      -      -      -      -      -    -'\n"
+        "exec sleep 10\n"); // nvidia-smi is a single process, the reader only kills that one
+    clearCalls();
+
+    NvidiaSmiSource source;
+    std::vector<ProcessSample> processes;
+
+    // the first sample is only complete once the second one starts
+    assert(!source.sampleProcesses(processes));
+    assert(pollUntil([&] { return source.sampleProcesses(processes); }));
+    assert(processes.size() == 2);
+    assert(processes[0].pid == 100 && processes[0].sm == 50 && processes[1].pid == 200 && processes[1].name == "Xorg");
+
+    assert(pollUntil([&] { return source.sampleProcesses(processes); }));
+    assert(processes.size() == 1 && processes[0].sm == 60);
+
+    // the last sample stays pending until the next time shows up
+    usleep(300000);
+    assert(!source.sampleProcesses(processes));
+    assert(processes.size() == 1 && processes[0].sm == 60);
+
+    assert(calls().size() == 1 && "nvidia-smi " + calls()[0] == NVSMI_CMD_PROCESSES_STREAM "1");
+    PROCESSES_DELAY = 0;
+}
+
+// a streaming nvidia-smi that dies is started again, its values are stale in between
+static void testStreamRestart() {
+    STREAMING = true;
+    UPDATE_DELAY = 100;
+    writeStub(
+        "runs=$(wc -l < '" + dir + "/calls')\n"
+        "echo \"0, Fake A100, $runs, 0, 40960, 40000, 960, GPU-a\"\n"
+        "sleep 0.1\n");
+    clearCalls();
+
+    NvidiaSmiSource source;
+    std::vector<GPUSample> gpus;
+
+    assert(pollUntil([&] { source.sampleGPUs(gpus); return gpus.size() == 1 && gpus[0].utilization == 1; }));
+    assert(pollUntil([&] { return !source.sampleGPUs(gpus); }));
+    assert(gpus[0].utilization == 1); // the old values are kept
+
+    assert(pollUntil([&] { return source.sampleGPUs(gpus) && gpus[0].utilization == 2; }));
+    assert(calls().size() >= 2);
+}
+
+int main() {
+    char path[] = "/tmp/nvsm-nvidiasmi-XXXXXX";
+    assert(mkdtemp(path));
+    dir = path;
+    setenv("PATH", (dir + ":" + getenv("PATH")).c_str(), 1);
+
+    testQuery();
+    testQueryFailure();
+    testStreamLoops();
+    testStreamPmon();
+    testStreamRestart();
+
+    system(("rm -rf " + dir).c_str());
+
+    return 0;
+}
@@ -0,0 +1,149 @@
+#include "test.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <dlfcn.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "nvml.h"
+
+// FAKE_NVML - path of the fakenvml library, defined by CMake
+
+#define FAKE_GPUS 2
+#define FAKE_PROCESSES 4
+
+struct FakeProcess {
+    unsigned int pid;
+    unsigned long long usedGpuMemory;
+    unsigned int gpuInstanceId, computeInstanceId;
+};
+
+struct FakeUtilization {
+    unsigned int pid;
+    unsigned long long timeStamp;
+    unsigned int smUtil, memUtil, encUtil, decUtil;
+};
+
+struct FakeDevice {
+    char name[64], uuid[64];
+    unsigned int gpu, memory;
+    unsigned long long total, free, used;
+    unsigned int computeCount, graphicsCount, utilizationCount;
+    FakeProcess compute[FAKE_PROCESSES], graphics[FAKE_PROCESSES];
+    FakeUtilization utilization[FAKE_PROCESSES];
+};
+
+struct FakeNvml {
+    unsigned int count;
+    FakeDevice devices[FAKE_GPUS];
+    int nameCalls;
+    unsigned long long lastSeen;
+};
+
+static FakeNvml *fake;
+static std::string procRoot;
+
+static void writeComm(const int pid, const std::string &name) {
+    std::string dir = procRoot + "/" + std::to_string(pid);
+    mkdir(dir.c_str(), 0755);
+    std::ofstream(dir + "/comm") << name << "\n";
+}
+
+static void setup() {
+    memset(fake, 0, sizeof *fake);
+    fake->count = 2;
+
+    for (int i = 0; i < FAKE_GPUS; i++) {
+        FakeDevice &device = fake->devices[i];
+        strcpy(device.name, "Tesla T4");
+        strcpy(device.uuid, i == 0 ? "GPU-a" : "GPU-b");
+        device.gpu = 10 + i;
+        device.memory = 20 + i;
+        device.total = 16ULL << 30;
+        device.used = 1ULL << 30;
+        device.free = device.total - device.used;
+    }
+
+    // 100 computes and draws on GPU 0, 200 only draws
+    FakeDevice &device = fake->devices[0];
+    device.computeCount = 1;
+    device.compute[0] = {100, 512ULL << 20, 0, 0};
+    device.graphicsCount = 2;
+    device.graphics[0] = {100, 512ULL << 20, 0, 0};
+    device.graphics[1] = {200, 64ULL << 20, 0, 0};
+    device.utilizationCount = 2;
+    device.utilization[0] = {100, 10, 5, 5, 5, 5};
+    device.utilization[1] = {100, 20, 50, 30, 1, 2};
+
+    writeComm(100, "python");
+}
+
+static void testGPUs(NVMLSource &nvml) {
+    std::vector<GPUSample> gpus;
+    assert(nvml.sampleGPUs(gpus));
+    assert(gpus.size() == 2);
+    assert(gpus[0].name == "Tesla T4" && gpus[0].uuid == "GPU-a" && gpus[1].uuid == "GPU-b");
+    assert(gpus[1].utilization == 11 && gpus[1].memoryUtilization == 21);
+    assert(gpus[0].memoryTotal == 16384 && gpus[0].memoryUsed == 1024 && gpus[0].memoryFree == 15360);
+
+    // names are read once per device
+    int calls = fake->nameCalls;
+    assert(nvml.sampleGPUs(gpus));
+    assert(fake->nameCalls == calls);
+}
+
+static void testProcesses(NVMLSource &nvml) {
+    std::vector<ProcessSample> processes;
+    assert(nvml.sampleProcesses(processes));
+    assert(processes.size() == 2);
+
+    const ProcessSample &both = processes[0], &graphics = processes[1];
+    assert(both.pid == 100 && both.type == "C+G" && both.GPUIndex == 0);
+    assert(both.name == "python"); // from procRoot
+    assert(both.fb == 512);
+
+    // the newest sample of the process
+    assert(both.sm == 50 && both.mem == 30 && both.enc == 1 && both.dec == 2);
+
+    // no sample, the process was idle
+    assert(graphics.pid == 200 && graphics.type == "G" && graphics.name == "-");
+    assert(graphics.sm == 0 && graphics.mem == 0);
+
+    // only samples after the last one read are asked for
+    assert(nvml.sampleProcesses(processes));
+    assert(fake->lastSeen == 20);
+    assert(processes[0].sm == 0);
+
+    fake->devices[0].utilization[0] = {100, 30, 70, 10, 0, 0};
+    assert(nvml.sampleProcesses(processes));
+    assert(processes[0].sm == 70 && processes[0].mem == 10);
+}
+
+int main() {
+    void *library = dlopen(FAKE_NVML, RTLD_NOW | RTLD_LOCAL);
+    assert(library);
+    fake = static_cast<FakeNvml*>(dlsym(library, "fakeNvml"));
+    assert(fake);
+
+    char root[] = "/tmp/nvsm-nvml-XXXXXX";
+    assert(mkdtemp(root));
+    procRoot = root;
+    setup();
+
+    {
+        NVMLSource nvml(FAKE_NVML, procRoot);
+        assert(nvml.isAvailable());
+        assert(nvml.getGPUCount() == 2);
+
+        testGPUs(nvml);
+        testProcesses(nvml);
+    }
+
+    system(("rm -rf " + procRoot).c_str());
+    dlclose(library);
+
+    return 0;
+}
@@ -0,0 +1,113 @@
+#include "test.h"
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "constants.h"
+#include "processesworker.h"
+
+#define FIRST_PID 100000000 // above pid_max, procfs has nothing for them
+#define PER_SAMPLE 64
+#define ROUNDS (NVSM_PROCESS_HISTORY_MAX / PER_SAMPLE + 16) // more processes than the history keeps
+
+// answers sampleProcesses() with processes, the GPUs are never sampled
+class ProcessesSource : public MetricsSource {
+public:
+    std::vector<ProcessSample> processes;
+
+    const char* getName() const override { return "processes"; }
+
+    bool sampleGPUs(std::vector<GPUSample>&) override { return false; }
+
+    bool sampleProcesses(std::vector<ProcessSample> &out) override {
+        out = processes;
+        return true;
+    }
+};
+
+static ProcessSample process(const int GPUIndex, const int pid, const int sm) {
+    ProcessSample sample;
+    sample.GPUIndex = GPUIndex;
+    sample.pid = pid;
+    sample.type = "C";
+    sample.name = "python";
+    sample.sm = sample.fb = sm;
+    return sample;
+}
+
+// pmon prints a row without a pid for an idle GPU
+static ProcessSample idle(const int GPUIndex) {
+    ProcessSample sample;
+    sample.GPUIndex = GPUIndex;
+    sample.pid = NVSM_NA;
+    sample.name = "-";
+    return sample;
+}
+
+// a process seen in several samples has a point for each, the idle row has no history
+static void testTrends() {
+    ProcessesSource source;
+    GPUSampler sampler;
+    sampler.source = &source;
+    ProcessesWorker worker;
+    worker.sampler = &sampler;
+
+    source.processes = {process(0, FIRST_PID, 10), idle(1)};
+    for (int i = 0; i < 3; i++) {
+        source.processes[0].sm = 10 * (i + 1);
+        worker.work();
+    }
+
+    std::shared_ptr<const ProcessesData> data = worker.data.load();
+    assert(data->processes.size() == 2 && data->trends.size() == 2);
+    assert(data->trends[0].size() == 3 && data->trends[0][2].computeUse == 30);
+    assert(data->trends[1].empty());
+
+    assert(data->pidIndex.size() == 1);
+    assert(data->processesIndexByPid(FIRST_PID) == 0);
+    assert(data->processesIndexByPid(NVSM_NA) == -1);
+    assert(worker.getHistorySize() == 1);
+}
+
+// many short-lived processes, each seen once, can not grow the history past its maximum
+static void testShortLived() {
+    ProcessesSource source;
+    GPUSampler sampler;
+    sampler.source = &source;
+    ProcessesWorker worker;
+    worker.sampler = &sampler;
+
+    int pid = FIRST_PID;
+    for (int round = 0; round < ROUNDS; round++) {
+        source.processes.clear();
+        for (int i = 0; i < PER_SAMPLE; i++)
+            source.processes.push_back(process(i % 2, pid++, i));
+        source.processes.push_back(idle(2));
+
+        worker.work();
+
+        std::shared_ptr<const ProcessesData> data = worker.data.load();
+        assert(data->processes.size() == PER_SAMPLE + 1);
+        assert(data->pidIndex.size() == PER_SAMPLE);
+        assert(data->processesIndexByPid(NVSM_NA) == -1);
+        assert(data->processesIndexByPid(pid - 1) == PER_SAMPLE - 1);
+        assert(worker.getHistorySize() <= NVSM_PROCESS_HISTORY_MAX);
+
+        // the processes of one sample share its time, the next sample must be later to expire them
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    assert(worker.getHistorySize() == NVSM_PROCESS_HISTORY_MAX);
+
+    // the processes of the last sample are kept, with their history
+    std::shared_ptr<const ProcessesData> data = worker.data.load();
+    assert(data->trends[PER_SAMPLE - 1].size() == 1);
+    assert(data->names->strings.size() <= 4);
+}
+
+int main() {
+    testTrends();
+    testShortLived();
+    return 0;
+}
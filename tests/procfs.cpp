@@ -0,0 +1,121 @@
+#include "test.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "procfs.h"
+
+#define CONTAINER "0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef"
+
+static std::string root;
+
+static void write(int pid, const std::string &file, const std::string &content) {
+    std::string dir = root + "/" + std::to_string(pid);
+    mkdir(dir.c_str(), 0755);
+    std::ofstream(dir + "/" + file, std::ios::binary) << content;
+}
+
+// fields 3 - 24 of proc(5), comm is written as is
+static void writeStat(int pid, const std::string &comm, unsigned long long utime, unsigned long long stime,
+                      unsigned long long startTime, long rss)
+{
+    write(pid, "stat", std::to_string(pid) + " (" + comm + ") S 1 1 1 0 -1 4194304 100 0 0 0 " +
+        std::to_string(utime) + " " + std::to_string(stime) + " 0 0 20 0 1 0 " + std::to_string(startTime) +
+        " 1000000 " + std::to_string(rss) + " 18446744073709551615 0 0 0 0 0 0 0 0 0 0 0 0 17 3 0 0\n");
+}
+
+static void writeProcess(int pid, const std::string &comm, unsigned long long startTime) {
+    writeStat(pid, comm, 100, 50, startTime, 256);
+    write(pid, "status", "Name:\t" + comm + "\nUmask:\t0022\nState:\tS (sleeping)\nUid:\t0\t0\t0\t0\nGid:\t0\t0\t0\t0\n");
+    write(pid, "cmdline", std::string("/usr/bin/") + comm + '\0' + "--flag" + '\0' + "value" + '\0');
+    write(pid, "cgroup", "12:memory:/user.slice\n0::/system.slice/docker-" CONTAINER ".scope\n");
+}
+
+static long pageSize() {
+    return sysconf(_SC_PAGESIZE) / 1024;
+}
+
+static void testIdentity() {
+    writeProcess(100, "python3", 1000);
+
+    ProcFS procfs(root);
+    procfs.update({100});
+
+    ProcessInfo info = procfs.get(100);
+    assert(info.identity);
+    assert(info.identity->uid == 0 && !info.identity->user.empty());
+    assert(info.identity->cmdline == "/usr/bin/python3 --flag value");
+    assert(info.identity->cgroup == "/system.slice/docker-" CONTAINER ".scope");
+    assert(info.identity->container == std::string(CONTAINER).substr(0, NVSM_CONTAINER_ID_SHORT));
+    assert(info.rss == 256 * pageSize());
+    assert(info.cpu == NVSM_PROCFS_NA); // needs two updates
+}
+
+// the fields after comm are counted from its last ')', comm itself may contain ") " and spaces
+static void testComm() {
+    writeProcess(101, "a) b (c) d", 1000);
+    writeStat(102, ") ) )", 7, 3, 2000, 512);
+
+    ProcFS procfs(root);
+    procfs.update({101, 102});
+
+    assert(procfs.get(101).identity && procfs.get(101).rss == 256 * pageSize());
+    assert(procfs.get(102).identity && procfs.get(102).rss == 512 * pageSize());
+
+    // truncated after starttime, no rss
+    write(103, "stat", "103 (x) y) S 1 1 1 0 -1 4194304 100 0 0 0 1 1 0 0 20 0 1 0 3000 1000000");
+    // no ')' at all
+    write(104, "stat", "104 x S 1 1 1 0 -1 4194304 100 0 0 0 1 1 0 0 20 0 1 0 3000 1000000 512");
+    // not a number where rss is
+    write(105, "stat", "105 (x) S 1 1 1 0 -1 4194304 100 0 0 0 1 1 0 0 20 0 1 0 3000 1000000 ?");
+
+    procfs.update({103, 104, 105});
+    assert(!procfs.get(103).identity && !procfs.get(104).identity && !procfs.get(105).identity);
+    assert(procfs.get(103).rss == NVSM_PROCFS_NA);
+}
+
+static void testUpdate() {
+    writeProcess(200, "render", 5000);
+
+    ProcFS procfs(root);
+    procfs.update({200, 200, 999}); // 200 uses two GPUs, 999 does not exist
+    std::shared_ptr<const ProcessIdentity> identity = procfs.get(200).identity;
+    assert(identity && !procfs.get(999).identity);
+
+    // the identity is kept while the start time is the same, the cpu use comes from the tick difference
+    usleep(50000);
+    write(200, "cmdline", std::string("changed") + '\0');
+    writeStat(200, "render", 100 + sysconf(_SC_CLK_TCK), 50, 5000, 256); // one second of cpu time
+    procfs.update({200});
+
+    ProcessInfo info = procfs.get(200);
+    assert(info.identity == identity);
+    assert(info.cpu > 0 && info.cpu <= 100000.0f / 50);
+
+    // a reused pid is read again
+    writeProcess(200, "other", 6000);
+    procfs.update({200});
+    assert(procfs.get(200).identity != identity && procfs.get(200).identity->cmdline == "/usr/bin/other --flag value");
+    assert(procfs.get(200).cpu == NVSM_PROCFS_NA);
+
+    // pids not given are forgotten
+    procfs.update({});
+    assert(!procfs.get(200).identity && procfs.get(200).rss == NVSM_PROCFS_NA);
+}
+
+int main() {
+    char dir[] = "/tmp/nvsm-procfs-XXXXXX";
+    assert(mkdtemp(dir));
+    root = dir;
+
+    testIdentity();
+    testComm();
+    testUpdate();
+
+    system(("rm -rf " + root).c_str());
+
+    return 0;
+}
@@ -0,0 +1,259 @@
+#include "test.h"
+
+#include <climits>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "constants.h"
+#include "recording.h"
+
+#define GPUS 2
+#define SAMPLES 3000 // several blocks
+
+struct Recorded {
+    long time;
+    std::vector<uint8_t> utilization;
+    std::vector<int> memoryUsed;
+};
+
+static std::string path;
+
+static std::vector<GPUSample> gpus() {
+    std::vector<GPUSample> gpus(GPUS);
+    gpus[0].uuid = "GPU-4d3f0a52";
+    gpus[0].name = "Tesla T4";
+    gpus[0].memoryTotal = 15360;
+    gpus[1].uuid = "GPU-9b1c7e08";
+    gpus[1].name = "A100";
+    gpus[1].memoryTotal = 40960;
+    return gpus;
+}
+
+static std::vector<Recorded> write(const long begin, const int count, const uint interval) {
+    std::vector<Recorded> samples;
+    RecordingWriter writer(path);
+    assert(writer.open(gpus(), interval));
+
+    long time = begin;
+    for (int i = 0; i < count; i++) {
+        // gaps from 0 to hours, memory going up and down by any amount
+        time += i % 100 == 99 ? 3600000 : rand() % 1000;
+        samples.push_back({time, {(uint8_t) (rand() % 101), (uint8_t) (rand() % 101)},
+                           {rand() % 15361, i % 2 == 0 ? 0 : 40960}});
+
+        const Recorded &sample = samples.back();
+        writer.add(sample.time, sample.utilization, sample.memoryUsed);
+        if (i % 500 == 0)
+            writer.flush(); // the block being filled is rewritten in place
+    }
+
+    writer.flush();
+    return samples;
+}
+
+static void check(Recording &recording, const std::vector<Recorded> &expected, long from, long to) {
+    size_t next = 0;
+    while (next < expected.size() && expected[next].time <= from)
+        next++;
+
+    recording.read(from, to, [&](long time, const std::vector<GPUSample> &samples) {
+        assert(next < expected.size());
+        const Recorded &sample = expected[next++];
+        assert(time == sample.time);
+        assert(samples.size() == GPUS);
+
+        for (int GPU = 0; GPU < GPUS; GPU++) {
+            assert(samples[GPU].utilization == sample.utilization[GPU]);
+            assert(samples[GPU].memoryUsed == sample.memoryUsed[GPU]);
+            assert(samples[GPU].memoryFree == gpus()[GPU].memoryTotal - sample.memoryUsed[GPU]);
+        }
+    });
+
+    assert(next == expected.size() || expected[next].time > to);
+}
+
+static void testVarint() {
+    for (uint64_t value : {0ULL, 1ULL, 127ULL, 128ULL, 16383ULL, 16384ULL, 1ULL << 35, ULLONG_MAX}) {
+        std::vector<uint8_t> out;
+        putVarint(out, value);
+
+        const uint8_t *in = out.data();
+        uint64_t decoded;
+        assert(getVarint(in, out.data() + out.size(), decoded));
+        assert(decoded == value && in == out.data() + out.size());
+
+        // cut short, it must not read past the end
+        in = out.data();
+        if (out.size() > 1)
+            assert(!getVarint(in, out.data() + out.size() - 1, decoded));
+    }
+
+    for (int64_t value : {0LL, 1LL, -1LL, 63LL, -64LL, 40960LL, -40960LL, LLONG_MAX, LLONG_MIN})
+        assert(unzigzag(zigzag(value)) == value);
+
+    // small deltas of either sign are one byte
+    assert(zigzag(-1) == 1 && zigzag(1) == 2 && zigzag(-64) < 128);
+}
+
+static void testRoundTrip() {
+    std::vector<Recorded> samples = write(1000000, SAMPLES, 500);
+
+    Recording recording;
+    assert(recording.open(path));
+    assert(recording.getGPUCount() == GPUS);
+    assert(recording.getInterval() == 500);
+    assert(recording.getNames()[1] == "A100");
+    assert(recording.getUUIDs()[1] == "GPU-9b1c7e08");
+    assert(recording.getBegin() == samples.front().time);
+    assert(recording.getEnd() == samples.back().time);
+
+    check(recording, samples, 0, LONG_MAX);
+
+    // random ranges, as seeking reads them
+    for (int i = 0; i < 100; i++) {
+        long from = samples[rand() % SAMPLES].time, to = from + rand() % 10000000;
+        check(recording, samples, from, to);
+    }
+}
+
+// appends to a recording of the same GPUs, the shorter interval wins
+static void testAppend() {
+    std::vector<Recorded> samples = write(1000000, 100, 500);
+    std::vector<Recorded> appended = write(samples.back().time + 1000, 100, 250);
+    samples.insert(samples.end(), appended.begin(), appended.end());
+
+    Recording recording;
+    assert(recording.open(path));
+    assert(recording.getInterval() == 250);
+    check(recording, samples, 0, LONG_MAX);
+}
+
+static long count(const std::string &path) {
+    Recording recording;
+    assert(recording.open(path));
+
+    long samples = 0;
+    recording.read(0, LONG_MAX, [&samples](long, const std::vector<GPUSample>&) { samples++; });
+    return samples;
+}
+
+// a recording of other GPUs is moved aside to the first free <path>.<n>, a new segment starts
+static void testSegments() {
+    std::vector<Recorded> samples = write(1000000, 100, 500);
+
+    // same count, one GPU swapped
+    std::vector<GPUSample> other = gpus();
+    other[1].uuid = "GPU-2e6f4410";
+    other[1].name = "A100";
+
+    RecordingWriter writer(path);
+    assert(writer.open(other, 500));
+    writer.add(samples.back().time + 1000, {10, 20}, {100, 200});
+    writer.flush();
+
+    Recording moved;
+    assert(moved.open(path + ".1"));
+    check(moved, samples, 0, LONG_MAX);
+
+    Recording segment;
+    assert(segment.open(path));
+    assert(segment.getUUIDs()[1] == "GPU-2e6f4410");
+    assert(count(path) == 1);
+
+    // the GPU count changes while recording: the writer starts over for the new ones
+    other.pop_back();
+    assert(writer.open(other, 500));
+    writer.add(samples.back().time + 2000, {30}, {300});
+    writer.flush();
+
+    assert(count(path + ".1") == (long) samples.size());
+    assert(count(path + ".2") == 1);
+    Recording single;
+    assert(single.open(path));
+    assert(single.getGPUCount() == 1 && count(path) == 1);
+
+    // samples of another count, without open(), stop the writer
+    writer.add(samples.back().time + 3000, {40, 50}, {400, 500});
+    assert(!writer.isOpen());
+    writer.add(samples.back().time + 4000, {60}, {600});
+    writer.flush();
+    assert(count(path) == 1);
+
+    // names or UUIDs that were not known match, the same GPUs are appended to
+    std::vector<GPUSample> unknown(1);
+    unknown[0].name = other[0].name;
+    RecordingWriter appending(path);
+    assert(appending.open(unknown, 500));
+    appending.add(samples.back().time + 5000, {70}, {700});
+    appending.flush();
+    assert(count(path) == 2);
+    assert(access((path + ".3").c_str(), F_OK) != 0);
+
+    unlink((path + ".1").c_str());
+    unlink((path + ".2").c_str());
+}
+
+// a crash while a block is written leaves it torn, the blocks before it still replay
+static void testTornBlock() {
+    std::vector<Recorded> samples = write(1000000, SAMPLES, 500);
+
+    int fd = open(path.c_str(), O_WRONLY);
+    off_t size = lseek(fd, 0, SEEK_END);
+    assert(size >= 4 * NVSM_RECORD_BLOCK_SIZE);
+    off_t last = size - NVSM_RECORD_BLOCK_SIZE;
+
+    // varints running past the size of the block
+    std::vector<uint8_t> garbage(NVSM_RECORD_BLOCK_SIZE - sizeof(BlockHeader), 0xff);
+    assert(pwrite(fd, garbage.data(), garbage.size(), last + sizeof(BlockHeader)) == (ssize_t) garbage.size());
+
+    // and a partial block after it
+    assert(pwrite(fd, garbage.data(), 100, size) == 100);
+    close(fd);
+
+    Recording recording;
+    assert(recording.open(path));
+    assert(recording.getEnd() < samples.back().time);
+
+    std::vector<Recorded> kept;
+    for (const Recorded &sample : samples)
+        if (sample.time <= recording.getEnd())
+            kept.push_back(sample);
+
+    // gaps can be 0, so the torn block may start with samples at the end time of the one before it
+    while ((long) kept.size() > count(path) && kept.back().time == recording.getEnd())
+        kept.pop_back();
+
+    assert(kept.size() > SAMPLES / 2);
+    check(recording, kept, 0, LONG_MAX);
+
+    // a recorder appending later starts on the next whole block
+    std::vector<Recorded> appended = write(samples.back().time + 1000, 10, 500);
+    Recording resumed;
+    assert(resumed.open(path));
+    assert(resumed.getEnd() == appended.back().time);
+    check(resumed, appended, appended.front().time - 1, LONG_MAX);
+}
+
+int main() {
+    char dir[] = "/tmp/nvsm-recording-XXXXXX";
+    assert(mkdtemp(dir));
+    path = std::string(dir) + "/recording";
+    srand(1);
+
+    testVarint();
+
+    testRoundTrip();
+    unlink(path.c_str());
+    testAppend();
+    unlink(path.c_str());
+    testSegments();
+    unlink(path.c_str());
+    testTornBlock();
+    unlink(path.c_str());
+
+    rmdir(dir);
+    return 0;
+}
@@ -0,0 +1,73 @@
+#include "test.h"
+
+#include "ringbuffer.h"
+
+static void testFIFO() {
+    RingBuffer<int> buffer(3);
+    assert(buffer.empty() && buffer.capacity() == 3);
+
+    buffer.push_back(1);
+    buffer.push_back(2);
+    assert(buffer.size() == 2 && buffer.front() == 1 && buffer.back() == 2);
+
+    buffer.pop_front();
+    assert(buffer.size() == 1 && buffer.front() == 2);
+
+    // wraps around the end of the storage
+    buffer.push_back(3);
+    buffer.push_back(4);
+    assert(buffer.full());
+    assert(buffer[0] == 2 && buffer[1] == 3 && buffer[2] == 4);
+
+    buffer.pop_back();
+    assert(buffer.size() == 2 && buffer.back() == 3);
+}
+
+// a full buffer overwrites its oldest element
+static void testOverwrite() {
+    RingBuffer<int> buffer(4);
+    for (int i = 0; i < 10; i++)
+        buffer.push_back(i);
+
+    assert(buffer.size() == 4);
+    for (size_t i = 0; i < buffer.size(); i++)
+        assert(buffer[i] == (int) i + 6);
+
+    buffer.clear();
+    assert(buffer.empty() && buffer.capacity() == 4);
+}
+
+static void testCapacity() {
+    RingBuffer<int> buffer(2);
+    buffer.push_back(1);
+
+    buffer.setCapacity(5);
+    assert(buffer.empty() && buffer.capacity() == 5);
+
+    // never 0, push_back must have somewhere to write
+    buffer.setCapacity(0);
+    assert(buffer.capacity() == 1);
+    buffer.push_back(7);
+    buffer.push_back(8);
+    assert(buffer.size() == 1 && buffer.front() == 8);
+}
+
+static void testDefault() {
+    RingBuffer<int> buffer;
+    assert(buffer.capacity() == 0 && buffer.empty());
+
+    buffer.push_back(1);
+    assert(buffer.empty() && buffer.capacity() == 0);
+
+    buffer.setCapacity(2);
+    buffer.push_back(2);
+    assert(buffer.size() == 1 && buffer.front() == 2);
+}
+
+int main() {
+    testFIFO();
+    testOverwrite();
+    testCapacity();
+    testDefault();
+    return 0;
+}
@@ -0,0 +1,138 @@
+#include "test.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "rowdiff.h"
+
+struct Row {
+    int key_, value;
+
+    int key() const { return key_; }
+    bool operator!=(const Row &other) const { return key_ != other.key_ || value != other.value; }
+};
+
+// a view that only learns about the rows from the calls, like a QTableView
+struct Mirror {
+    std::vector<Row> rows;
+    const std::vector<Row> *incoming = nullptr;
+    std::vector<size_t> from; // row -> index in incoming
+    size_t removing = SIZE_MAX, inserting = SIZE_MAX;
+    int removedRows = 0, changedRows = 0, insertedRows = 0;
+
+    void beginRemove(size_t first, size_t last) {
+        assert(removing == SIZE_MAX && first <= last && last < rows.size());
+        removing = first;
+    }
+
+    void endRemove(size_t first, size_t last) {
+        assert(removing == first);
+        rows.erase(rows.begin() + first, rows.begin() + last + 1);
+        from.erase(from.begin() + first, from.begin() + last + 1);
+        removedRows += last - first + 1;
+        removing = SIZE_MAX;
+    }
+
+    void kept(size_t row, size_t index, bool changed) {
+        assert(rows[row].key() == (*incoming)[index].key());
+        assert(changed == (rows[row] != (*incoming)[index]));
+        rows[row] = (*incoming)[index];
+        from[row] = index;
+        changedRows += changed;
+    }
+
+    void beginInsert(size_t first, size_t last) {
+        assert(first == rows.size() && first <= last);
+        inserting = last;
+    }
+
+    void inserted(size_t row, size_t index) {
+        assert(row == rows.size());
+        rows.push_back((*incoming)[index]);
+        from.push_back(index);
+        insertedRows++;
+    }
+
+    void endInsert() {
+        assert(rows.size() == inserting + 1);
+        inserting = SIZE_MAX;
+    }
+};
+
+static void apply(std::vector<Row> &rows, Mirror &mirror, const std::vector<Row> &incoming) {
+    std::vector<Row> before = rows;
+    mirror.incoming = &incoming;
+    mirror.removedRows = mirror.changedRows = mirror.insertedRows = 0;
+
+    bool moved = diffRows(rows, incoming, mirror);
+
+    // the view saw the same rows
+    assert(mirror.rows.size() == rows.size());
+    for (size_t i = 0; i < rows.size(); i++) {
+        assert(!(mirror.rows[i] != rows[i]));
+        assert(!(incoming[mirror.from[i]] != rows[i]));
+    }
+
+    // every incoming row once
+    assert(rows.size() == incoming.size());
+    std::vector<int> keys, expected;
+    for (const Row &row : rows)
+        keys.push_back(row.key());
+    for (const Row &row : incoming)
+        expected.push_back(row.key());
+    std::sort(keys.begin(), keys.end());
+    std::sort(expected.begin(), expected.end());
+    assert(keys == expected);
+
+    // rows that stayed kept their order, ahead of the new ones
+    size_t kept = 0;
+    for (const Row &row : before)
+        if (std::find(expected.begin(), expected.end(), row.key()) != expected.end())
+            assert(rows[kept++].key() == row.key());
+    assert(kept + mirror.insertedRows == rows.size());
+    assert(moved == (mirror.removedRows > 0 || mirror.insertedRows > 0));
+}
+
+static void testSteps() {
+    std::vector<Row> rows;
+    Mirror mirror;
+
+    apply(rows, mirror, {{1, 0}, {2, 0}, {3, 0}, {4, 0}});
+    assert(mirror.insertedRows == 4);
+
+    // unchanged: no signal at all
+    apply(rows, mirror, {{4, 0}, {3, 0}, {2, 0}, {1, 0}});
+    assert(mirror.removedRows == 0 && mirror.changedRows == 0 && mirror.insertedRows == 0);
+    assert(rows[0].key() == 1); // rows do not follow the snapshot order
+
+    apply(rows, mirror, {{1, 5}, {4, 0}, {6, 0}, {5, 0}});
+    assert(mirror.removedRows == 2 && mirror.changedRows == 1 && mirror.insertedRows == 2);
+    assert(rows[2].key() == 6 && rows[3].key() == 5); // new ones in snapshot order
+
+    apply(rows, mirror, {});
+    assert(rows.empty() && mirror.removedRows == 4);
+}
+
+static void testRandom() {
+    std::vector<Row> rows;
+    Mirror mirror;
+    std::mt19937 random(1);
+
+    for (int tick = 0; tick < 1000; tick++) {
+        std::vector<Row> incoming;
+        for (int key = 0; key < 64; key++)
+            if (random() % 3 != 0)
+                incoming.push_back({key, (int) (random() % 3)});
+        std::shuffle(incoming.begin(), incoming.end(), random);
+
+        apply(rows, mirror, incoming);
+    }
+}
+
+int main() {
+    testSteps();
+    testRandom();
+    return 0;
+}
@@ -0,0 +1,68 @@
+#include "test.h"
+
+#include <string>
+#include <signal.h>
+
+#include "utils.h"
+
+static void testOutput() {
+    unsigned long spawned = getSpawnCount();
+
+    ExecResult result = run("echo out; echo err >&2; exit 3", 1000);
+    assert(!result.timedOut && result.status == 3 && !result.ok());
+    assert(result.out == "out\n" && result.err == "err\n");
+    assert(getSpawnCount() == spawned + 1);
+
+    result = run("printf 'a b\\tc'", 1000);
+    assert(result.ok() && result.out == "a b\tc" && result.err.empty());
+
+    // stdin is /dev/null, a command reading it does not hang
+    result = run("cat; echo done", 1000);
+    assert(result.ok() && result.out == "done\n");
+
+    assert(exec("echo ok") == "ok\n");
+    assert(exec("echo partial; false").empty());
+}
+
+// more than a pipe buffer on both streams at once, read as it comes
+static void testLarge() {
+    ExecResult result = run("head -c 1000000 /dev/zero; head -c 300000 /dev/zero >&2", 3000);
+    assert(result.ok());
+    assert(result.out.size() == 1000000 && result.err.size() == 300000);
+}
+
+static void testSignal() {
+    ExecResult result = run("kill -TERM $$", 1000);
+    assert(!result.timedOut && result.status == 128 + SIGTERM);
+}
+
+// the whole process group is killed, a child that keeps the pipes open can not delay the caller
+static void testTimeout() {
+    long begin = getTime();
+    ExecResult result = run("echo started; sleep 10 & sleep 10", 200);
+    long elapsed = getTime() - begin;
+
+    assert(result.timedOut && result.status == -1 && !result.ok());
+    assert(result.out == "started\n");
+    assert(elapsed >= 200 && elapsed < 200 + NVSM_EXEC_KILL_GRACE + 1000);
+
+    // output closed, but the command is still running
+    begin = getTime();
+    result = run("exec >/dev/null 2>&1; sleep 10", 200);
+    assert(result.timedOut && getTime() - begin < 200 + NVSM_EXEC_KILL_GRACE + 1000);
+}
+
+static void testNotFound() {
+    ExecResult result = run("/nonexistent/command", 1000);
+    assert(!result.timedOut && result.status == 127);
+    assert(!result.err.empty());
+}
+
+int main() {
+    testOutput();
+    testLarge();
+    testSignal();
+    testTimeout();
+    testNotFound();
+    return 0;
+}
@@ -0,0 +1,201 @@
+#include "test.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "parser.h"
+#include "sampler.h"
+
+#define READERS 8
+#define SLOW_SAMPLES 20
+#define SLOW_DELAY 20 // ms a slow source takes for one sample
+
+// answers sampleGPUs() with the lines of one combined query, counting the calls
+class QuerySource : public MetricsSource {
+public:
+    std::vector<std::string> lines;
+    bool fail = false;
+    int calls = 0;
+
+    const char* getName() const override { return "query"; }
+
+    bool sampleGPUs(std::vector<GPUSample> &gpus) override {
+        calls++;
+        if (fail)
+            return false;
+
+        for (const std::string &line : lines)
+            parseGPUQueryLine(line, gpus);
+        return !gpus.empty();
+    }
+
+    bool sampleProcesses(std::vector<ProcessSample>&) override { return false; }
+};
+
+static void testQueryLine() {
+    std::vector<GPUSample> gpus;
+
+    assert(parseGPUQueryLine("1, Tesla T4, 35, 12, 15360, 15000, 360, GPU-b", gpus));
+    assert(gpus.size() == 2);
+    assert(gpus[1].name == "Tesla T4");
+    assert(gpus[1].utilization == 35 && gpus[1].memoryUtilization == 12);
+    assert(gpus[1].memoryTotal == 15360 && gpus[1].memoryFree == 15000 && gpus[1].memoryUsed == 360);
+    assert(gpus[1].uuid == "GPU-b");
+
+    // older collectors and fleet commands print no uuid
+    assert(parseGPUQueryLine("0, Tesla T4, [N/A], 0, 15360, 15360, 0", gpus));
+    assert(gpus[0].utilization == 0 && gpus[0].uuid.empty());
+
+    assert(!parseGPUQueryLine("0, Tesla T4, 35", gpus));
+    assert(!parseGPUQueryLine("", gpus));
+    assert(!parseGPUQueryLine("99999, garbage, 0, 0, 0, 0, 0", gpus));
+    assert(gpus.size() == 2);
+}
+
+// one source call per tick, shared by every reader
+static void testSample() {
+    QuerySource source;
+    source.lines = {"0, A100, 10, 20, 40960, 40000, 960, GPU-a", "1, A100, 30, 40, 40960, 30000, 10960, GPU-b"};
+
+    GPUSampler sampler;
+    sampler.source = &source;
+    sampler.sample();
+
+    assert(source.calls == 1);
+    assert(!sampler.stale);
+
+    auto snapshot = sampler.getSnapshot();
+    assert(snapshot->size() == 2);
+    assert((*snapshot)[1].utilization == 30);
+    assert(sampler.getTopology()->gpus.size() == 2);
+    assert(sampler.getTopology()->gpus[0].uuid == "GPU-a");
+
+    // a failed sample keeps the last snapshot and marks it stale
+    source.fail = true;
+    sampler.sample();
+    assert(source.calls == 2);
+    assert(sampler.stale);
+    assert(sampler.getSnapshot() == snapshot);
+
+    source.fail = false;
+    source.lines[0] = "0, A100, 50, 20, 40960, 40000, 960, GPU-a";
+    sampler.sample();
+    assert(!sampler.stale);
+    assert((*sampler.getSnapshot())[0].utilization == 50);
+    assert((*snapshot)[0].utilization == 10); // published snapshots never change
+}
+
+// takes SLOW_DELAY for every sample, every value of sample n is n
+class SlowSource : public MetricsSource {
+public:
+    std::atomic<bool> sampling {false}; // inside a call, readers must still get through
+    int generation = 0;
+
+    const char* getName() const override { return "slow"; }
+
+    bool sampleGPUs(std::vector<GPUSample> &gpus) override {
+        return slowly([&]() {
+            gpus.resize(4);
+            for (size_t i = 0; i < gpus.size(); i++) {
+                gpus[i].uuid = "GPU-" + std::to_string(i);
+                gpus[i].utilization = gpus[i].memoryUsed = generation;
+            }
+        });
+    }
+
+    bool sampleProcesses(std::vector<ProcessSample> &processes) override {
+        return slowly([&]() {
+            processes.assign(16, ProcessSample());
+            for (ProcessSample &process : processes)
+                process.pid = process.sm = generation;
+        });
+    }
+
+private:
+    template<typename F>
+    bool slowly(F fill) {
+        sampling = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(SLOW_DELAY));
+        fill();
+        sampling = false;
+        return true;
+    }
+};
+
+// whole samples only, never older than one seen before
+template<typename T, typename V>
+static void checkSample(const std::shared_ptr<const std::vector<T>> &sample, int &last, V value) {
+    if (sample->empty())
+        return;
+
+    int generation = value(sample->front());
+    for (const T &item : *sample)
+        assert(value(item) == generation);
+    assert(generation >= last);
+    last = generation;
+}
+
+// readers load the snapshots of the GPUs and the processes, as the widgets and the servers do,
+// while the source is in the middle of a slow sample
+static void testReaders() {
+    SlowSource source;
+    GPUSampler sampler;
+    sampler.source = &source;
+    Snapshot<std::vector<ProcessSample>> processes; // published like ProcessesWorker::data
+
+    std::atomic<bool> done(false);
+    std::vector<long> blockedLoads(READERS, 0);
+    std::vector<std::thread> readers;
+
+    for (int reader = 0; reader < READERS; reader++) {
+        readers.emplace_back([&, reader]() {
+            int lastGPUs = 0, lastProcesses = 0;
+
+            while (!done) {
+                bool sampling = source.sampling;
+
+                checkSample(sampler.getSnapshot(), lastGPUs, [](const GPUSample &gpu) {
+                    assert(gpu.memoryUsed == gpu.utilization);
+                    return gpu.utilization;
+                });
+                checkSample(processes.load(), lastProcesses, [](const ProcessSample &process) {
+                    assert(process.sm == process.pid);
+                    return process.pid;
+                });
+                assert(sampler.getTopology()->gpus.size() <= 4);
+
+                if (sampling && source.sampling)
+                    blockedLoads[reader]++;
+            }
+        });
+    }
+
+    for (int i = 1; i <= SLOW_SAMPLES; i++) {
+        source.generation = i;
+        sampler.sample();
+
+        std::vector<ProcessSample> next;
+        if (source.sampleProcesses(next))
+            processes.store(std::make_shared<const std::vector<ProcessSample>>(std::move(next)));
+    }
+
+    done = true;
+    for (std::thread &reader : readers)
+        reader.join();
+
+    // every reader got through while a sample was being taken
+    for (long loads : blockedLoads)
+        assert(loads > 0);
+
+    assert((*sampler.getSnapshot())[3].utilization == SLOW_SAMPLES);
+    assert(processes.load()->back().pid == SLOW_SAMPLES);
+}
+
+int main() {
+    testQueryLine();
+    testSample();
+    testReaders();
+    return 0;
+}
@@ -0,0 +1,19 @@
+// the settings of main.cpp, with its defaults, for the tests of code that reads them
+#include "settings.h"
+
+uint UPDATE_DELAY = 2000;
+uint GRAPH_LENGTH = 60000;
+uint PROCESSES_DELAY = 0;
+int GPU_COUNT = -1;
+bool STREAMING = true;
+std::string METRICS_SOURCE = NVSM_SOURCE_AUTO;
+std::string NVML_LIBRARY = NVML_LIBRARY_DEFAULT;
+uint METRICS_PORT = 0;
+std::string RECORD_PATH;
+std::string PROC_ROOT = NVSM_PROCFS_ROOT;
+std::vector<std::string> ALERT_RULES;
+std::vector<std::string> FLEET_HOSTS;
+std::string FLEET_COMMAND = NVSM_FLEET_COMMAND_DEFAULT;
+uint FLEET_DELAY = 5000;
+uint FLEET_TIMEOUT = 4000;
+uint BACKGROUND_DELAY = 10000;
@@ -0,0 +1,84 @@
+#include "test.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <deque>
+#include <vector>
+
+#include "statistics.h"
+
+#define WINDOW 50
+#define VALUES 5000
+
+// the window computed from scratch, nearest-rank percentiles
+static void check(const WindowStatistics &statistics, const std::deque<int> &window) {
+    std::vector<int> sorted(window.begin(), window.end());
+    std::sort(sorted.begin(), sorted.end());
+
+    long sum = 0;
+    for (int value : sorted)
+        sum += value;
+
+    assert(statistics.average() == sum / (long) sorted.size());
+    assert(statistics.minimum() == sorted.front());
+    assert(statistics.maximum() == sorted.back());
+
+    for (float p : {0.0f, 0.5f, 0.9f, 0.99f, 1.0f}) {
+        auto rank = (size_t) std::ceil(p * sorted.size());
+        assert(statistics.percentile(p) == sorted[rank > 0 ? rank - 1 : 0]);
+    }
+}
+
+static void testSlidingWindow() {
+    WindowStatistics statistics;
+    statistics.setCapacity(WINDOW);
+    std::deque<int> window;
+
+    srand(1);
+    for (int i = 0; i < VALUES; i++) {
+        // runs of equal values, so the deques see ties too
+        int value = rand() % 4 == 0 ? window.empty() ? 0 : window.back() : rand() % 101;
+
+        if (window.size() == WINDOW) {
+            statistics.pop(window.front());
+            window.pop_front();
+        }
+
+        statistics.push(value);
+        window.push_back(value);
+        check(statistics, window);
+    }
+}
+
+static void testEmpty() {
+    WindowStatistics statistics;
+    statistics.setCapacity(4);
+    assert(statistics.average() == 0 && statistics.minimum() == 0 && statistics.maximum() == 0);
+    assert(statistics.percentile(0.5f) == 0);
+
+    statistics.push(30);
+    statistics.pop(30);
+    assert(statistics.average() == 0 && statistics.maximum() == 0);
+
+    statistics.push(40);
+    statistics.clear();
+    assert(statistics.average() == 0 && statistics.percentile(1) == 0);
+}
+
+// values outside [0; 100] count as the nearest bound
+static void testClamp() {
+    WindowStatistics statistics;
+    statistics.setCapacity(2);
+    statistics.push(-5);
+    statistics.push(250);
+    assert(statistics.minimum() == 0 && statistics.maximum() == STATISTICS_MAX_VALUE);
+    assert(statistics.average() == 50);
+}
+
+int main() {
+    testSlidingWindow();
+    testEmpty();
+    testClamp();
+    return 0;
+}
@@ -0,0 +1,72 @@
+#include "test.h"
+
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+#include "stream.h"
+#include "utils.h"
+
+#define WAIT_MAX 3000 // ms
+
+// the reader execs cmd, a script has to be run by a shell of its own
+#define SCRIPT(script) "sh -c \"" script "\""
+
+// polls until done() or WAIT_MAX, collecting the lines
+template<typename F>
+static std::vector<std::string> pollUntil(StreamReader &stream, F &&done) {
+    std::vector<std::string> lines;
+    long begin = getTime();
+
+    while (!done(lines) && getTime() - begin < WAIT_MAX) {
+        stream.poll([&lines](std::string_view line) { lines.emplace_back(line); });
+        usleep(10000);
+    }
+
+    return lines;
+}
+
+// a line written in two parts is handed out once, complete
+static void testLines() {
+    StreamReader stream(SCRIPT("printf 'first\\nsec'; sleep 0.2; printf 'ond\\n'; sleep 5"), 1000);
+    auto lines = pollUntil(stream, [](auto &lines) { return lines.size() >= 2; });
+
+    assert(lines.size() == 2);
+    assert(lines[0] == "first");
+    assert(lines[1] == "second");
+    assert(stream.isRunning());
+}
+
+static void testExit() {
+    StreamReader stream("echo done", 1000);
+    pollUntil(stream, [&stream](auto &lines) { return !lines.empty() && !stream.isRunning(); });
+
+    assert(!stream.isRunning());
+}
+
+// a child that prints nothing for timeout ms is stopped
+static void testTimeout() {
+    StreamReader stream("sleep 5", 100);
+    stream.poll([](std::string_view) { assert(false); });
+    assert(stream.isRunning());
+
+    pollUntil(stream, [&stream](auto&) { return !stream.isRunning(); });
+    assert(!stream.isRunning());
+}
+
+// stdin is /dev/null, so a child reading it does not wait for the terminal
+static void testStdin() {
+    StreamReader stream(SCRIPT("cat; echo eof; sleep 5"), 1000);
+    auto lines = pollUntil(stream, [](auto &lines) { return !lines.empty(); });
+
+    assert(lines.size() == 1);
+    assert(lines[0] == "eof");
+}
+
+int main() {
+    testLines();
+    testExit();
+    testTimeout();
+    testStdin();
+    return 0;
+}
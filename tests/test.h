@@ -0,0 +1,8 @@
+#ifndef TEST_H
+#define TEST_H
+
+// plain asserts, also in release builds
+#undef NDEBUG
+#include <cassert>
+
+#endif
@@ -0,0 +1,102 @@
+#include "test.h"
+
+#include "topology.h"
+
+static GPUSample gpu(const std::string &uuid, const std::string &name, int memoryTotal = 8192) {
+    GPUSample sample;
+    sample.uuid = uuid;
+    sample.name = name;
+    sample.memoryTotal = memoryTotal;
+    return sample;
+}
+
+static void testKey() {
+    assert(gpuKey(gpu("GPU-a", "A100"), 3) == "GPU-a");
+    assert(gpuKey(gpu("", "A100"), 3) == "#3 A100");
+}
+
+static void testFingerprint() {
+    std::vector<GPUSample> gpus = {gpu("GPU-a", "A100"), gpu("GPU-b", "A100")};
+    uint64_t fingerprint = gpuFingerprint(gpus);
+
+    // values that change every sample do not count
+    gpus[0].utilization = 90;
+    gpus[1].memoryUsed = 100;
+    assert(gpuFingerprint(gpus) == fingerprint);
+
+    std::vector<GPUSample> swapped = {gpus[1], gpus[0]};
+    assert(gpuFingerprint(swapped) != fingerprint);
+
+    std::vector<GPUSample> fewer = {gpus[0]};
+    assert(gpuFingerprint(fewer) != fingerprint && gpuFingerprint({}) != gpuFingerprint(fewer));
+
+    // keys can not run into each other
+    assert(gpuFingerprint({gpu("ab", ""), gpu("c", "")}) != gpuFingerprint({gpu("a", ""), gpu("bc", "")}));
+
+    // without UUIDs the index and the name count
+    std::vector<GPUSample> unnamed = {gpu("", "T4"), gpu("", "T4")};
+    assert(gpuFingerprint(unnamed) != gpuFingerprint({gpu("", "T4")}));
+    unnamed[1].name = "L4";
+    assert(gpuFingerprint(unnamed) != gpuFingerprint({gpu("", "T4"), gpu("", "T4")}));
+}
+
+static void testCache() {
+    GPUMetadataCache cache;
+    assert(cache.get()->gpus.empty() && cache.get()->generation == 0);
+
+    std::vector<GPUSample> gpus = {gpu("GPU-a", "A100", 40960), gpu("", "T4", 16384)};
+    assert(cache.update(gpus));
+
+    std::shared_ptr<const GPUTopology> topology = cache.get();
+    assert(topology->generation == 1 && topology->gpus.size() == 2);
+    assert(topology->gpus[0].key == "GPU-a" && topology->gpus[0].memoryTotal == 40960);
+    assert(topology->gpus[1].key == "#1 T4" && topology->gpus[1].uuid.empty());
+    assert(topology->indexes.at("GPU-a") == 0 && topology->indexes.at("#1 T4") == 1);
+
+    // same GPUs, nothing is rebuilt
+    gpus[0].utilization = 50;
+    assert(!cache.update(gpus));
+    assert(cache.get() == topology);
+
+    // a GPU fell off the bus, readers keep the topology they have
+    gpus.erase(gpus.begin());
+    assert(cache.update(gpus));
+    assert(cache.get()->generation == 2 && cache.get()->gpus[0].key == "#0 T4");
+    assert(topology->gpus.size() == 2);
+}
+
+static void testRemap() {
+    std::vector<std::string> keys;
+
+    std::vector<int> from = remapGPUs(keys, {gpu("GPU-a", "A100"), gpu("GPU-b", "A100")});
+    assert((from == std::vector<int>{-1, -1}));
+    assert((keys == std::vector<std::string>{"GPU-a", "GPU-b"}));
+
+    // indexes shift, every GPU keeps its state
+    from = remapGPUs(keys, {gpu("GPU-c", "H100"), gpu("GPU-b", "A100"), gpu("GPU-a", "A100")});
+    assert((from == std::vector<int>{-1, 1, 0}));
+
+    // a GPU vanished, its state is dropped
+    from = remapGPUs(keys, {gpu("GPU-a", "A100"), gpu("GPU-c", "H100")});
+    assert((from == std::vector<int>{2, 0}));
+    assert((keys == std::vector<std::string>{"GPU-a", "GPU-c"}));
+
+    // without UUIDs a GPU is only followed at the same index
+    keys.clear();
+    remapGPUs(keys, {gpu("", "T4"), gpu("", "L4")});
+    from = remapGPUs(keys, {gpu("", "L4"), gpu("", "T4")});
+    assert((from == std::vector<int>{-1, -1}));
+    from = remapGPUs(keys, {gpu("", "L4")});
+    assert((from == std::vector<int>{0}));
+
+    from = remapGPUs(keys, {});
+    assert(from.empty() && keys.empty());
+}
+
+int main() {
+    testKey();
+    testFingerprint();
+    testCache();
+    testRemap();
+    return 0;
+}
@@ -0,0 +1,186 @@
+#include "test.h"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "worker.h"
+
+using namespace std::chrono;
+
+#define INTERVAL 50 // ms
+#define TOLERANCE 20 // ms of wake-up latency allowed for one run, it must not add up
+
+static long since(const steady_clock::time_point begin) {
+    return duration_cast<milliseconds>(steady_clock::now() - begin).count();
+}
+
+// start times of the runs of a job, in ms after begin
+struct Runs {
+    steady_clock::time_point begin = steady_clock::now();
+    std::mutex mutex;
+    std::vector<long> starts;
+
+    void add() {
+        std::lock_guard<std::mutex> lock(mutex);
+        starts.push_back(since(begin));
+    }
+
+    size_t count() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return starts.size();
+    }
+};
+
+// deadlines are absolute: a job that takes part of the period does not shift the next runs
+static void testGrid() {
+    Runs runs;
+    WorkerThread thread(nullptr);
+    thread.addTask(INTERVAL, [&runs] {
+        runs.add();
+        std::this_thread::sleep_for(milliseconds(INTERVAL / 2));
+    });
+
+    thread.start();
+    std::this_thread::sleep_for(milliseconds(20 * INTERVAL + INTERVAL / 2));
+    thread.stop();
+    thread.wait();
+
+    assert(runs.starts.size() == 21);
+    for (size_t i = 0; i < runs.starts.size(); i++) {
+        long expected = i * INTERVAL;
+        assert(runs.starts[i] >= expected && runs.starts[i] < expected + TOLERANCE);
+    }
+
+    TaskStatistics statistics = thread.getStatistics(0);
+    assert(statistics.runs == 21 && statistics.skipped == 0);
+}
+
+// a job slower than its interval skips the periods it missed instead of queueing them
+static void testSkip() {
+    Runs runs;
+    std::atomic<int> running(0), overlapped(0);
+    WorkerThread thread(nullptr);
+    thread.addTask(INTERVAL, [&] {
+        if (running++ > 0)
+            overlapped++;
+        runs.add();
+        std::this_thread::sleep_for(milliseconds(INTERVAL * 5 / 2));
+        running--;
+    });
+
+    thread.start();
+    std::this_thread::sleep_for(milliseconds(12 * INTERVAL + INTERVAL / 2));
+    thread.stop();
+    thread.wait();
+
+    // a run every 3 intervals, on the grid: the first deadline after the previous run ended
+    assert(overlapped == 0);
+    assert(runs.starts.size() == 5);
+    for (size_t i = 0; i < runs.starts.size(); i++) {
+        long expected = i * 3 * INTERVAL;
+        assert(runs.starts[i] >= expected && runs.starts[i] < expected + TOLERANCE);
+    }
+
+    TaskStatistics statistics = thread.getStatistics(0);
+    assert(statistics.runs == 5 && statistics.skipped == 8);
+}
+
+// 0 pauses: the job does not run again, the pause callback runs once, after a running job
+static void testPause() {
+    std::atomic<int> jobs(0), pauses(0), running(0), overlapped(0);
+    WorkerThread thread(nullptr);
+    size_t task = thread.addTask(INTERVAL, [&] {
+        running++;
+        jobs++;
+        std::this_thread::sleep_for(milliseconds(INTERVAL / 2));
+        running--;
+    }, [&] {
+        if (running > 0)
+            overlapped++;
+        pauses++;
+    });
+
+    thread.start();
+    std::this_thread::sleep_for(milliseconds(INTERVAL / 4)); // the first run is busy
+    thread.setInterval(task, 0);
+    assert(thread.getInterval(task) == 0);
+
+    std::this_thread::sleep_for(milliseconds(4 * INTERVAL));
+    assert(jobs == 1 && pauses == 1 && overlapped == 0);
+
+    // the same interval again changes nothing
+    thread.setInterval(task, 0);
+    std::this_thread::sleep_for(milliseconds(2 * INTERVAL));
+    assert(jobs == 1 && pauses == 1);
+
+    // resumed, it runs at once
+    steady_clock::time_point resumed = steady_clock::now();
+    thread.setInterval(task, 10 * INTERVAL);
+    while (jobs < 2 && since(resumed) < 10 * INTERVAL)
+        std::this_thread::sleep_for(milliseconds(1));
+    assert(jobs == 2 && since(resumed) < TOLERANCE + INTERVAL / 2);
+
+    thread.stop();
+    thread.wait();
+    assert(pauses == 1);
+}
+
+// the loop sleeps on a wait condition, so stop() does not wait for the next deadline
+static void testStop() {
+    std::atomic<int> jobs(0);
+    WorkerThread thread(nullptr);
+    thread.addTask(100 * INTERVAL, [&jobs] { jobs++; });
+
+    thread.start();
+    while (jobs < 1)
+        std::this_thread::sleep_for(milliseconds(1));
+
+    steady_clock::time_point stopped = steady_clock::now();
+    thread.stop();
+    thread.wait();
+    assert(since(stopped) < TOLERANCE);
+    assert(jobs == 1);
+}
+
+// refresh() runs every task at once, setInterval() runs the changed one at once
+static void testWake() {
+    Runs fast, slow;
+    WorkerThread thread(nullptr);
+    thread.addTask(100 * INTERVAL, [&fast] { fast.add(); });
+    size_t task = thread.addTask(100 * INTERVAL, [&slow] { slow.add(); });
+
+    thread.start();
+    while (fast.count() < 1 || slow.count() < 1)
+        std::this_thread::sleep_for(milliseconds(1));
+    std::this_thread::sleep_for(milliseconds(INTERVAL));
+
+    steady_clock::time_point woken = steady_clock::now();
+    thread.refresh();
+    while ((fast.count() < 2 || slow.count() < 2) && since(woken) < 10 * INTERVAL)
+        std::this_thread::sleep_for(milliseconds(1));
+    assert(fast.count() == 2 && slow.count() == 2);
+    assert(since(woken) < TOLERANCE);
+    std::this_thread::sleep_for(milliseconds(INTERVAL));
+
+    woken = steady_clock::now();
+    thread.setInterval(task, 200 * INTERVAL);
+    while (slow.count() < 3 && since(woken) < 10 * INTERVAL)
+        std::this_thread::sleep_for(milliseconds(1));
+    assert(slow.count() == 3 && fast.count() == 2);
+    assert(since(woken) < TOLERANCE);
+
+    thread.stop();
+    thread.wait();
+}
+
+int main() {
+    testGrid();
+    testSkip();
+    testPause();
+    testStop();
+    testWake();
+    return 0;
+}